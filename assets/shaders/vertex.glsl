@@ -4,6 +4,7 @@
 
 layout(location = 0) in vec3 in_pos;
 layout(location = 1) in vec2 in_coords;
+layout(location = 2) in vec2 in_offset;
 out vec2 var_coords;
 
 // Global uniforms.
@@ -15,6 +16,6 @@ uniform vec4 coords;
 
 void main()
 {
-    gl_Position = vec4(in_pos * scale + position, 1.0f) * projection;
+    gl_Position = vec4(in_pos * scale + position + vec3(in_offset, 0.0f), 1.0f) * projection;
     var_coords = in_coords * coords.zw + coords.xy;
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Fixed-size queue of commands passed from one thread to another without locking;
+// Only one thread may push commands and only one other thread may pop them.
+
+template <typename T, size_t capacity>
+class CommandQueue
+{
+    static_assert((capacity & (capacity - 1)) == 0, "Command queue capacity must be a power of two.");
+
+public:
+    CommandQueue()
+        : commands(), head(0), tail(0)
+    {}
+
+    // Add a command to the back of the queue;
+    // Fails instead of waiting when the queue is full.
+
+    bool Push(const T& command)
+    {
+        size_t back = tail.load(std::memory_order_relaxed);
+
+        if (back - head.load(std::memory_order_acquire) == capacity)
+        {
+            return false;
+        }
+
+        commands[back & (capacity - 1)] = command;
+        tail.store(back + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Take the command from the front of the queue, if there is one.
+
+    bool Pop(T& outCommand)
+    {
+        size_t front = head.load(std::memory_order_relaxed);
+
+        if (front == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        outCommand = commands[front & (capacity - 1)];
+        head.store(front + 1, std::memory_order_release);
+
+        return true;
+    }
+
+private:
+    T commands[capacity];
+
+    // Each end is written by one thread, so they are kept on separate cache lines.
+
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif
\ No newline at end of file
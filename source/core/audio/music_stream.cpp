@@ -0,0 +1,266 @@
+#include "music_stream.h"
+#include "core/file/asset_pack.h"
+#include "core/logging.h"
+#include "core/maths/maths.h"
+#include <algorithm>
+#include <chrono>
+
+// Time the decoding thread sleeps between fills, well under the length of the buffer.
+
+constexpr auto musicFillInterval = std::chrono::milliseconds(20);
+
+// Initialise the music stream, silent until a track is played;
+// Without a thread, the owner fills the buffer itself, which keeps offline mixing deterministic.
+
+MusicStream::MusicStream(int channels, int sampleRate, bool threaded)
+    : fadeFrames(musicChunkFrames * channels), tracks(), current(0), fadeLength((unsigned int) (musicFadeTime * sampleRate)),
+      fadePosition(fadeLength), channels(channels), sampleRate(sampleRate), requested(false), stopping(false)
+{
+    ma_pcm_rb_init(ma_format_f32, (ma_uint32) channels, musicBufferFrames, nullptr, nullptr, &buffer);
+
+    if (threaded)
+    {
+        worker = std::thread(&MusicStream::Work, this);
+    }
+}
+
+// Terminate the music stream.
+
+MusicStream::~MusicStream()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_one();
+
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+
+    CloseTrack(tracks[0]);
+    CloseTrack(tracks[1]);
+
+    ma_pcm_rb_uninit(&buffer);
+}
+
+// Crossfade to a track, or to silence if the path is empty;
+// The track changes once the music already buffered has played.
+
+void MusicStream::Play(std::string_view path)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requestedPath = path;
+        requested = true;
+    }
+
+    condition.notify_one();
+}
+
+// Decode music until the buffer is full, switching track if one was requested.
+
+void MusicStream::Fill()
+{
+    std::string path;
+    bool changed = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (requested && requestedPath != currentPath)
+        {
+            path = requestedPath;
+            changed = true;
+        }
+
+        requested = false;
+    }
+
+    // The current track becomes the one faded out, cutting off any track still fading.
+
+    if (changed)
+    {
+        current = 1 - current;
+        CloseTrack(tracks[current]);
+
+        if (!path.empty())
+        {
+            OpenTrack(tracks[current], path);
+        }
+
+        currentPath = path;
+        fadePosition = 0;
+    }
+
+    // Decode straight into the buffer, blending in the previous track while fading.
+
+    while (ma_pcm_rb_available_write(&buffer) > 0)
+    {
+        ma_uint32 frameCount = musicChunkFrames;
+        void* pFrames;
+
+        ma_pcm_rb_acquire_write(&buffer, &frameCount, &pFrames);
+
+        float* pSamples = (float*) pFrames;
+        DecodeTrack(tracks[current], pSamples, frameCount);
+
+        if (fadePosition < fadeLength)
+        {
+            DecodeTrack(tracks[1 - current], fadeFrames.data(), frameCount);
+
+            for (ma_uint32 i = 0; i < frameCount; i++)
+            {
+                float amount = Min((float) (fadePosition + i) / (float) fadeLength, 1.0f);
+
+                for (int channel = 0; channel < channels; channel++)
+                {
+                    size_t sample = i * channels + channel;
+                    pSamples[sample] = pSamples[sample] * amount + fadeFrames[sample] * (1.0f - amount);
+                }
+            }
+
+            fadePosition += frameCount;
+
+            if (fadePosition >= fadeLength)
+            {
+                CloseTrack(tracks[1 - current]);
+            }
+        }
+
+        ma_pcm_rb_commit_write(&buffer, frameCount);
+    }
+}
+
+// Add buffered music to the output at a volume, returning the frames that were available;
+// Called from the mixer, which is the only reader of the buffer.
+
+unsigned int MusicStream::Mix(float* pOutput, unsigned int frameCount, float volume)
+{
+    unsigned int mixedCount = 0;
+
+    while (mixedCount < frameCount)
+    {
+        ma_uint32 readCount = frameCount - mixedCount;
+        void* pFrames;
+
+        if (ma_pcm_rb_acquire_read(&buffer, &readCount, &pFrames) != MA_SUCCESS || readCount == 0)
+        {
+            break;
+        }
+
+        const float* pSamples = (const float*) pFrames;
+        float* pTarget = pOutput + (size_t) mixedCount * channels;
+
+        for (size_t i = 0; i < (size_t) readCount * channels; i++)
+        {
+            pTarget[i] += pSamples[i] * volume;
+        }
+
+        ma_pcm_rb_commit_read(&buffer, readCount);
+        mixedCount += readCount;
+    }
+
+    return mixedCount;
+}
+
+// Get the bytes of decoded music held at once.
+
+size_t MusicStream::GetSize() const
+{
+    return ((size_t) musicBufferFrames + musicChunkFrames) * channels * sizeof(float);
+}
+
+// Keep the buffer full until the stream is terminated.
+
+void MusicStream::Work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping)
+    {
+        lock.unlock();
+        Fill();
+        lock.lock();
+
+        condition.wait_for(lock, musicFillInterval, [this] { return requested || stopping; });
+    }
+}
+
+// Open a track for decoding in the output's format;
+// Loose tracks are read from the file as they play rather than mapped, so they never become resident.
+
+bool MusicStream::OpenTrack(Track& track, const std::string& path)
+{
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, (ma_uint32) channels, (ma_uint32) sampleRate);
+    const unsigned char* pData;
+    size_t size;
+    ma_result result;
+
+    if (pAssetPack && pAssetPack->Find(path, pData, size))
+    {
+        result = ma_decoder_init_memory(pData, size, &config, &track.decoder);
+    }
+    else
+    {
+        result = ma_decoder_init_file(path.c_str(), &config, &track.decoder);
+    }
+
+    if (result != MA_SUCCESS)
+    {
+        ERR("Failed to load music from \"" << path << "\".");
+
+        return false;
+    }
+
+    track.open = true;
+
+    LOG("Streaming music from \"" << path << "\".");
+
+    return true;
+}
+
+// Close a track, if it is open.
+
+void MusicStream::CloseTrack(Track& track)
+{
+    if (track.open)
+    {
+        ma_decoder_uninit(&track.decoder);
+        track.open = false;
+    }
+}
+
+// Decode frames of a track, looping back to its start at the end;
+// Closed tracks decode to silence.
+
+void MusicStream::DecodeTrack(Track& track, float* pFrames, unsigned int frameCount)
+{
+    unsigned int decodedCount = 0;
+    bool looped = false;
+
+    while (track.open && decodedCount < frameCount)
+    {
+        ma_uint64 readCount = 0;
+        ma_decoder_read_pcm_frames(&track.decoder, pFrames + (size_t) decodedCount * channels, frameCount - decodedCount, &readCount);
+
+        decodedCount += (unsigned int) readCount;
+
+        // Stop if the track is empty, rather than seeking back forever.
+
+        if (decodedCount < frameCount)
+        {
+            if (readCount == 0 && looped)
+            {
+                break;
+            }
+
+            ma_decoder_seek_to_pcm_frame(&track.decoder, 0);
+            looped = readCount == 0;
+        }
+    }
+
+    std::fill(pFrames + (size_t) decodedCount * channels, pFrames + (size_t) frameCount * channels, 0.0f);
+}
\ No newline at end of file
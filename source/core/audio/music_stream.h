@@ -0,0 +1,79 @@
+#ifndef MUSIC_STREAM_H
+#define MUSIC_STREAM_H
+
+#include "miniaudio.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Frames of decoded music kept ahead of the mixer, and frames decoded at a time.
+
+constexpr unsigned int musicBufferFrames = 16384;
+constexpr unsigned int musicChunkFrames = 2048;
+
+// Length of the crossfade between tracks in seconds, and the music's volume.
+
+constexpr float musicFadeTime = 1.0f;
+constexpr float musicVolume = 0.5f;
+
+// Looping music, decoded a chunk at a time into a ring buffer read by the mixer;
+// Memory use is bounded by the buffer, whatever the length of the track.
+
+class MusicStream
+{
+public:
+    MusicStream(int channels, int sampleRate, bool threaded);
+    ~MusicStream();
+
+    void Play(std::string_view path);
+    void Fill();
+    unsigned int Mix(float* pOutput, unsigned int frameCount, float volume);
+
+    size_t GetSize() const;
+
+private:
+    // Track being decoded from the asset pack or a file.
+
+    struct Track
+    {
+        ma_decoder decoder;
+        bool open;
+    };
+
+    void Work();
+
+    bool OpenTrack(Track& track, const std::string& path);
+    void CloseTrack(Track& track);
+    void DecodeTrack(Track& track, float* pFrames, unsigned int frameCount);
+
+    ma_pcm_rb buffer;
+    std::vector<float> fadeFrames;
+
+    // Tracks are only touched by the thread filling the buffer;
+    // While fading, the previous track is mixed out as the current one is mixed in.
+
+    Track tracks[2];
+    int current;
+    std::string currentPath;
+    unsigned int fadeLength;
+    unsigned int fadePosition;
+
+    int channels;
+    int sampleRate;
+
+    // Shared with the decoding thread.
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    std::string requestedPath;
+    bool requested;
+    bool stopping;
+
+    std::thread worker;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "sound_bank.h"
+#include "core/file/asset_pack.h"
+#include "core/logging.h"
+#include "miniaudio.h"
+#include <algorithm>
+#include <filesystem>
+
+// Frames decoded at a time while filling the bank.
+
+constexpr size_t decodeChunkFrames = 4096;
+
+// Decode every sound in the asset pack and directory;
+// Sounds are resampled to the output once, here, rather than while playing.
+
+SoundBank::SoundBank(std::string_view directory, int channels, int sampleRate)
+    : channels(channels), sampleRate(sampleRate)
+{
+    START_METRIC("sound_bank");
+
+    std::string prefix = std::string(directory) + "/";
+    std::vector<std::string> names;
+
+    if (pAssetPack)
+    {
+        names = pAssetPack->List(prefix, ".wav");
+    }
+
+    std::error_code error;
+
+    for (const auto& file : std::filesystem::directory_iterator(directory, error))
+    {
+        if (file.path().extension() == ".wav")
+        {
+            names.push_back(file.path().stem().string());
+        }
+    }
+
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    for (const std::string& name : names)
+    {
+        Decode(prefix + name + ".wav");
+    }
+
+    // Release the space left over from decoding in chunks.
+
+    samples.shrink_to_fit();
+
+    STOP_METRIC("sound_bank");
+
+    LOG("Loaded the sound bank (" << entries.size() << " sounds, " << GetSize() << " bytes).");
+}
+
+// Find the index of a sound by its path;
+// Returns -1 if the sound is not in the bank.
+
+int SoundBank::Find(std::string_view path) const
+{
+    auto compare = [](const Entry& entry, std::string_view value) { return entry.path < value; };
+    auto location = std::lower_bound(entries.begin(), entries.end(), path, compare);
+
+    if (location == entries.end() || location->path != path)
+    {
+        return -1;
+    }
+
+    return (int) (location - entries.begin());
+}
+
+// Get the frames of a sound by its index.
+
+void SoundBank::GetFrames(int sound, const float*& outFrames, size_t& outFrameCount) const
+{
+    outFrames = samples.data() + entries[sound].offset;
+    outFrameCount = entries[sound].frameCount;
+}
+
+// Get the number of sounds in the bank.
+
+int SoundBank::GetCount() const
+{
+    return (int) entries.size();
+}
+
+// Get the number of interleaved channels in each frame.
+
+int SoundBank::GetChannels() const
+{
+    return channels;
+}
+
+// Get the sample rate sounds were decoded at.
+
+int SoundBank::GetSampleRate() const
+{
+    return sampleRate;
+}
+
+// Get the bytes of samples held by the bank.
+
+size_t SoundBank::GetSize() const
+{
+    return samples.size() * sizeof(float);
+}
+
+// Decode a sound from the asset pack or a file onto the end of the bank.
+
+bool SoundBank::Decode(const std::string& path)
+{
+    Asset file;
+    ma_decoder decoder;
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, (ma_uint32) channels, (ma_uint32) sampleRate);
+
+    if (!file.Open(path) || ma_decoder_init_memory(file.GetData(), file.GetSize(), &config, &decoder) != MA_SUCCESS)
+    {
+        ERR("Failed to load sound from \"" << path << "\".");
+
+        return false;
+    }
+
+    // Read the sound in chunks, as the resampled length is not known up front.
+
+    size_t offset = samples.size();
+    ma_uint64 framesRead = 0;
+
+    do
+    {
+        size_t end = samples.size();
+        samples.resize(end + decodeChunkFrames * channels);
+
+        ma_decoder_read_pcm_frames(&decoder, samples.data() + end, decodeChunkFrames, &framesRead);
+        samples.resize(end + (size_t) framesRead * channels);
+    }
+    while (framesRead == decodeChunkFrames);
+
+    ma_decoder_uninit(&decoder);
+
+    size_t frameCount = (samples.size() - offset) / channels;
+    entries.push_back({path, offset, frameCount});
+
+    LOG("Loaded sound from \"" << path << "\" (" << frameCount * channels * sizeof(float) << " bytes).");
+
+    return true;
+}
\ No newline at end of file
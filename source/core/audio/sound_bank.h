@@ -0,0 +1,43 @@
+#ifndef SOUND_BANK_H
+#define SOUND_BANK_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Every sound in a directory, decoded once into one block of samples;
+// Sounds are stored as interleaved floats at the output's channel count and sample rate.
+
+class SoundBank
+{
+public:
+    SoundBank(std::string_view directory, int channels, int sampleRate);
+
+    int Find(std::string_view path) const;
+    void GetFrames(int sound, const float*& outFrames, size_t& outFrameCount) const;
+
+    int GetCount() const;
+    int GetChannels() const;
+    int GetSampleRate() const;
+    size_t GetSize() const;
+
+private:
+    // Location of a sound's frames within the bank.
+
+    struct Entry
+    {
+        std::string path;
+        size_t offset;
+        size_t frameCount;
+    };
+
+    bool Decode(const std::string& path);
+
+    std::vector<float> samples;
+    std::vector<Entry> entries;
+
+    int channels;
+    int sampleRate;
+};
+
+#endif
\ No newline at end of file
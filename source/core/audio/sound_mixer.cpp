@@ -2,74 +2,308 @@
 #define MA_NO_MP3
 #define MA_NO_FLAC
 #define MA_NO_GENERATION
+#define MA_NO_RESOURCE_MANAGER
 #define MA_NO_NULL
 
 #include "sound_mixer.h"
+#include "music_stream.h"
 #include "core/logging.h"
+#include "core/maths/maths.h"
 #include "miniaudio.h"
+#include <algorithm>
+#include <chrono>
 
 #undef PlaySound
 
 SoundMixer* pSoundMixer;
 
-// Load sound data from a file.
+// Flags every voice is initialised with.
 
-static void LoadSoundFile(std::string_view path, std::unique_ptr<ma_engine>& pEngine, std::unique_ptr<ma_sound>& outSound)
+constexpr ma_uint32 soundFlags = MA_SOUND_FLAG_NO_PITCH | MA_SOUND_FLAG_NO_SPATIALIZATION;
+
+// Frames mixed at once when rendering without a device.
+
+constexpr ma_uint32 offlineChunkFrames = 1024;
+
+// Get the time on a steady clock in microseconds.
+
+static long long GetSteadyTime()
 {
-    constexpr ma_uint32 flags = MA_SOUND_FLAG_NO_PITCH | MA_SOUND_FLAG_NO_SPATIALIZATION;
-    ma_result result = ma_sound_init_from_file(pEngine.get(), path.data(), flags, nullptr, nullptr, outSound.get());
+    auto time = std::chrono::steady_clock::now().time_since_epoch();
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+}
+
+// Sound being played, with its own position in the sound's frames.
+
+struct SoundMixer::Voice
+{
+    ma_audio_buffer_ref source;
+    ma_sound sound;
+
+    unsigned long long startOrder;
+};
+
+// Initialise the sound mixer;
+// The mixer owns the playback device, whose audio thread drives the engine;
+// Zero sample rate, period size, or period count leaves it to the device.
+
+SoundMixer::SoundMixer(int sampleRate, int periodSize, int periodCount)
+    : pMusic(nullptr, nullptr), masterVolume(1.0f), pVoices(nullptr, nullptr), bufferLatency(0.0), lastCallbackTime(0),
+      totalWaitTime(0), waitCount(0), underrunCount(0),
+      callbackCount(0), totalMixTime(0), totalBufferTime(0), peakLoad(0.0f), overrunCount(0), activeVoiceCount(0),
+      peakVoiceCount(0), droppedCount(0), offline(false), pendingFrames(0.0), mixTime(0.0), mixedFrames(0),
+      soundCount(0), playCount(0), time(0.0)
+{
+    pSoundMixer = this;
+
+    ma_device_config deviceConfig = ma_device_config_init(ma_device_type_playback);
+    deviceConfig.playback.format = ma_format_f32;
+    deviceConfig.sampleRate = (ma_uint32) sampleRate;
+    deviceConfig.periodSizeInFrames = (ma_uint32) periodSize;
+    deviceConfig.periods = (ma_uint32) periodCount;
+    deviceConfig.performanceProfile = ma_performance_profile_low_latency;
+    deviceConfig.dataCallback = OnDeviceData;
+    deviceConfig.pUserData = this;
 
-    if (result == MA_SUCCESS)
+    pDevice = std::make_unique<ma_device>();
+
+    if (ma_device_init(nullptr, &deviceConfig, pDevice.get()) != MA_SUCCESS)
     {
-        LOG("Loaded sound from \"" << path << "\".");
+        ERR("Failed to open an audio device.");
+
+        pDevice.reset();
+    }
+
+    // The device may not grant the requested buffer, so the one it chose is reported.
+
+    if (pDevice)
+    {
+        ma_uint32 deviceRate = pDevice->playback.internalSampleRate;
+        ma_uint32 devicePeriod = pDevice->playback.internalPeriodSizeInFrames;
+        ma_uint32 devicePeriods = pDevice->playback.internalPeriods;
+
+        bufferLatency = (double) devicePeriod * devicePeriods / Max(deviceRate, 1u);
+
+        LOG("Opened an audio device (" << deviceRate << " Hz, " << devicePeriods << " periods of "
+            << devicePeriod << " frames, " << bufferLatency * 1000.0 << "ms buffered).");
+
+        Initialise((int) pDevice->playback.channels, (int) pDevice->sampleRate);
+        ma_device_start(pDevice.get());
     }
     else
     {
-        ERR("Failed to load sound from \"" << path << "\".");
+        Initialise(offlineChannels, offlineSampleRate);
     }
+
+    LOG("Initialised the Sound Mixer.");
 }
 
-// Initialise the sound mixer.
+// Initialise an offline sound mixer, which mixes in step with the game instead of a device;
+// The mix is written to a WAV file at the output path, or discarded if it is empty.
 
-SoundMixer::SoundMixer()
+SoundMixer::SoundMixer(std::string_view outputPath)
+    : pMusic(nullptr, nullptr), masterVolume(1.0f), pVoices(nullptr, nullptr), bufferLatency(0.0), lastCallbackTime(0),
+      totalWaitTime(0), waitCount(0), underrunCount(0),
+      callbackCount(0), totalMixTime(0), totalBufferTime(0), peakLoad(0.0f), overrunCount(0), activeVoiceCount(0),
+      peakVoiceCount(0), droppedCount(0), offline(true), pendingFrames(0.0), mixTime(0.0), mixedFrames(0),
+      soundCount(0), playCount(0), time(0.0)
 {
     pSoundMixer = this;
 
-    pEngine = std::make_unique<ma_engine>();
-    ma_engine_init(nullptr, pEngine.get());
+    Initialise(offlineChannels, offlineSampleRate);
+    offlineFrames.resize(offlineChunkFrames * offlineChannels);
 
-    LOG("Initialised the Sound Mixer.");
+    if (!outputPath.empty())
+    {
+        std::string path(outputPath);
+        ma_encoder_config encoderConfig = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, offlineChannels, offlineSampleRate);
+
+        pEncoder = std::make_unique<ma_encoder>();
+
+        if (ma_encoder_init_file(path.c_str(), &encoderConfig, pEncoder.get()) != MA_SUCCESS)
+        {
+            ERR("Failed to open \"" << path << "\" to write audio.");
+
+            pEncoder.reset();
+        }
+    }
+
+    LOG("Initialised the offline Sound Mixer.");
 }
 
-// Terminate the sound mixer.
+// Terminate the sound mixer;
+// The device is stopped first, so the audio thread no longer touches the voices.
 
 SoundMixer::~SoundMixer()
 {
-    for (std::unique_ptr<ma_sound>& pSound : sounds)
+    if (pDevice)
+    {
+        ma_device_uninit(pDevice.get());
+
+        LOG("Audio output latency was " << GetOutputLatency() * 1000.0 << "ms, with "
+            << GetUnderrunCount() << " underruns.");
+    }
+
+    if (pEncoder)
     {
-        ma_sound_uninit(pSound.get());
+        ma_encoder_uninit(pEncoder.get());
+    }
+
+    for (int sound = 0; sound < (int) createdVoiceCounts.size(); sound++)
+    {
+        for (int i = 0; i < createdVoiceCounts[sound]; i++)
+        {
+            Voice& voice = pVoices[sound * maxVoiceCount + i];
+
+            ma_sound_uninit(&voice.sound);
+            ma_audio_buffer_ref_uninit(&voice.source);
+        }
     }
 
     ma_engine_uninit(pEngine.get());
 }
 
-// Set the master volume multiplier.
+// Send the sounds queued during a tick to the audio thread;
+// Plays of the same sound are merged into one louder play, unless it is cooling down.
+
+void SoundMixer::Update(float delta)
+{
+    time += delta;
+
+    for (int sound = 0; sound < (int) sounds.size(); sound++)
+    {
+        VoicePool& pool = sounds[sound];
+
+        if (pool.queuedCount == 0)
+        {
+            continue;
+        }
+
+        if (time - pool.lastPlayTime >= pool.cooldown)
+        {
+            float volume = Min(1.0f + mergedVolumeStep * (float) (pool.queuedCount - 1), maxMergedVolume);
+
+            SendCommand({COMMAND_PLAY, sound, volume, GetSteadyTime()});
+            pool.lastPlayTime = time;
+        }
+
+        pool.queuedCount = 0;
+    }
+
+    if (offline)
+    {
+        MixOffline(delta);
+    }
+}
+
+// Get the real time spent mixing offline, in seconds.
+
+double SoundMixer::GetMixTime() const
+{
+    return mixTime;
+}
+
+// Get the length of audio mixed offline, in seconds.
+
+double SoundMixer::GetMixedTime() const
+{
+    return (double) mixedFrames / offlineSampleRate;
+}
+
+// Get the average time from playing a sound to hearing it, in seconds;
+// This is the time the command waited for the audio thread plus the device's buffer.
+
+double SoundMixer::GetOutputLatency() const
+{
+    int count = waitCount.load(std::memory_order_relaxed);
+    double waitTime = count > 0 ? (double) totalWaitTime.load(std::memory_order_relaxed) / count / 1e6 : 0.0;
+
+    return waitTime + bufferLatency;
+}
+
+// Get how many times the device ran out of audio to play.
+
+int SoundMixer::GetUnderrunCount() const
+{
+    return underrunCount.load(std::memory_order_relaxed);
+}
+
+// Get the latest health of the audio callback, as published by the audio thread.
+
+AudioHealth SoundMixer::GetHealth() const
+{
+    int count = Max(callbackCount.load(std::memory_order_relaxed), 1);
+
+    AudioHealth health;
+    health.mixTime = (double) totalMixTime.load(std::memory_order_relaxed) / count / 1e9;
+    health.bufferTime = (double) totalBufferTime.load(std::memory_order_relaxed) / count / 1e9;
+    health.peakLoad = peakLoad.load(std::memory_order_relaxed);
+    health.outputLatency = GetOutputLatency();
+    health.activeVoices = activeVoiceCount.load(std::memory_order_relaxed);
+    health.peakVoices = peakVoiceCount.load(std::memory_order_relaxed);
+    health.underruns = GetUnderrunCount();
+    health.overruns = overrunCount.load(std::memory_order_relaxed);
+    health.droppedCommands = droppedCount;
+
+    return health;
+}
+
+// Record the audio callback's health with the performance metrics.
+
+void SoundMixer::RecordMetrics() const
+{
+#if _DEBUG
+    AudioHealth health = GetHealth();
+
+    SET_METRIC_VALUE("audio_mix_ms", health.mixTime * 1000.0);
+    SET_METRIC_VALUE("audio_buffer_ms", health.bufferTime * 1000.0);
+    SET_METRIC_VALUE("audio_peak_load", health.peakLoad);
+    SET_METRIC_VALUE("audio_latency_ms", health.outputLatency * 1000.0);
+    SET_METRIC_VALUE("audio_peak_voices", health.peakVoices);
+    SET_METRIC_VALUE("audio_underruns", health.underruns);
+    SET_METRIC_VALUE("audio_overruns", health.overruns);
+    SET_METRIC_VALUE("audio_dropped_commands", health.droppedCommands);
+#endif
+}
+
+// Set the master volume multiplier on the audio thread.
 
 void SoundMixer::SetMasterVolume(float volume)
 {
-    ma_engine_set_volume(pEngine.get(), volume);
+    SendCommand({COMMAND_VOLUME, 0, volume, GetSteadyTime()});
+}
+
+// Stream a track as music, crossfading from the current one;
+// An empty path fades the music out.
+
+void SoundMixer::PlayMusic(std::string_view path)
+{
+    pMusic->Play(path);
 }
 
-// Play a specified sound.
+// Queue a specified sound to be played at the end of the tick.
 
 void SoundMixer::PlaySound(const Sound& sound)
 {
-    ma_engine_play_sound(pEngine.get(), files[sound.identifier].data(), nullptr);
+    if (sound.identifier < 0)
+    {
+        return;
+    }
+
+    VoicePool& pool = sounds[sound.identifier];
+
+    if (pool.voiceCount > 0)
+    {
+        pool.queuedCount++;
+    }
 }
 
-// Get a sound from file path.
+// Get a sound from file path;
+// Its voices were created with the sound bank, so this only chooses how many of them it uses;
+// The voice count limits how many plays overlap, and the cooldown is the least time between plays.
 
-Sound SoundMixer::GetSound(std::string_view path)
+Sound SoundMixer::GetSound(std::string_view path, int voiceCount, int priority, float cooldown)
 {
     auto location = std::find(files.begin(), files.end(), path);
 
@@ -80,12 +314,314 @@ Sound SoundMixer::GetSound(std::string_view path)
         return {(int) (location - files.begin())};
     }
 
-    // Otherwise, load the sound from a file.
+    if ((int) sounds.size() == maxSounds)
+    {
+        ERR("Too many sounds to load \"" << path << "\".");
+
+        return {-1};
+    }
+
+    // Otherwise, take the sound's voices from the bank.
+
+    int index = pBank->Find(path);
+    Voice* pPoolVoices = nullptr;
+    voiceCount = Clamp(voiceCount, 1, maxVoiceCount);
+
+    if (index == -1)
+    {
+        ERR("Sound \"" << path << "\" is not in the sound bank.");
+
+        voiceCount = 0;
+    }
+    else
+    {
+        pPoolVoices = &pVoices[index * maxVoiceCount];
+        voiceCount = Min(voiceCount, createdVoiceCounts[index]);
+    }
 
     files.emplace_back(path);
-    sounds.push_back(std::make_unique<ma_sound>());
+    sounds.push_back({pPoolVoices, voiceCount, priority, cooldown, -1e9, 0});
 
-    LoadSoundFile(path, pEngine, sounds.back());
+    // Publish the sound to the audio thread once it is set up.
+
+    soundCount.store((int) sounds.size(), std::memory_order_release);
 
     return {(int) files.size() - 1};
+}
+
+// Create the engine in an output format, then decode every sound up front in it and create its voices;
+// Music is decoded as it plays, on its own thread unless mixing offline.
+
+void SoundMixer::Initialise(int channels, int sampleRate)
+{
+    sounds.reserve(maxSounds);
+
+    ma_engine_config engineConfig = ma_engine_config_init();
+    engineConfig.noDevice = MA_TRUE;
+    engineConfig.channels = (ma_uint32) channels;
+    engineConfig.sampleRate = (ma_uint32) sampleRate;
+
+    pEngine = std::make_unique<ma_engine>();
+    ma_engine_init(&engineConfig, pEngine.get());
+
+    pBank = std::make_unique<SoundBank>("assets/sounds", channels, sampleRate);
+
+    // Give each voice its own view of its sound's frames, so each keeps its own position.
+
+    int bankCount = pBank->GetCount();
+
+    pVoices = {new Voice[(size_t) bankCount * maxVoiceCount](), [](Voice* pVoices) { delete[] pVoices; }};
+    createdVoiceCounts.assign(bankCount, 0);
+
+    for (int sound = 0; sound < bankCount; sound++)
+    {
+        const float* pFrames;
+        size_t frameCount;
+
+        pBank->GetFrames(sound, pFrames, frameCount);
+
+        for (int i = 0; i < maxVoiceCount; i++)
+        {
+            Voice& voice = pVoices[sound * maxVoiceCount + i];
+
+            ma_audio_buffer_ref_init(ma_format_f32, (ma_uint32) channels, pFrames, frameCount, &voice.source);
+            voice.source.sampleRate = (ma_uint32) sampleRate;
+
+            if (ma_sound_init_from_data_source(pEngine.get(), &voice.source, soundFlags, nullptr, &voice.sound) != MA_SUCCESS)
+            {
+                ma_audio_buffer_ref_uninit(&voice.source);
+
+                break;
+            }
+
+            createdVoiceCounts[sound]++;
+        }
+    }
+
+    pMusic = {new MusicStream(channels, sampleRate, !offline), [](MusicStream* pStream) { delete pStream; }};
+}
+
+// Fill the device's buffer from the audio thread.
+
+void SoundMixer::OnDeviceData(ma_device* pDevice, void* pOutput, const void* /* pInput */, unsigned int frameCount)
+{
+    ((SoundMixer*) pDevice->pUserData)->Mix((float*) pOutput, frameCount);
+}
+
+// Carry out the commands sent since the last buffer, then mix the engine's output;
+// Runs on the audio thread, which is the only one to start or stop voices.
+
+void SoundMixer::Mix(float* pOutput, unsigned int frameCount)
+{
+    auto mixStart = std::chrono::steady_clock::now();
+    long long callbackTime = GetSteadyTime();
+
+    // A callback arriving later than the device's whole buffer lasts means the device ran dry.
+
+    if (pDevice && lastCallbackTime != 0 && (double) (callbackTime - lastCallbackTime) / 1e6 > bufferLatency)
+    {
+        underrunCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    lastCallbackTime = callbackTime;
+
+    Command command;
+
+    while (commands.Pop(command))
+    {
+        if (command.type == COMMAND_PLAY)
+        {
+            StartSound(sounds[command.sound], command.volume);
+
+            totalWaitTime.fetch_add(callbackTime - command.sendTime, std::memory_order_relaxed);
+            waitCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            ma_engine_set_volume(pEngine.get(), command.volume);
+            masterVolume = command.volume;
+        }
+    }
+
+    ma_engine_read_pcm_frames(pEngine.get(), pOutput, frameCount, nullptr);
+    pMusic->Mix(pOutput, frameCount, musicVolume * masterVolume);
+
+    // Publish how long mixing took compared to how long the buffer will play.
+
+    long long mixTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mixStart).count();
+    long long bufferTime = (long long) frameCount * 1000000000ll / ma_engine_get_sample_rate(pEngine.get());
+    float load = (float) mixTime / (float) Max(bufferTime, 1ll);
+    int voiceCount = CountActiveVoices();
+
+    totalMixTime.fetch_add(mixTime, std::memory_order_relaxed);
+    totalBufferTime.fetch_add(bufferTime, std::memory_order_relaxed);
+    activeVoiceCount.store(voiceCount, std::memory_order_relaxed);
+
+    if (load > peakLoad.load(std::memory_order_relaxed))
+    {
+        peakLoad.store(load, std::memory_order_relaxed);
+    }
+
+    if (voiceCount > peakVoiceCount.load(std::memory_order_relaxed))
+    {
+        peakVoiceCount.store(voiceCount, std::memory_order_relaxed);
+    }
+
+    if (mixTime > bufferTime)
+    {
+        overrunCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    callbackCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Mix the frames covering a tick on this thread, writing them to the output file if there is one;
+// Fractions of a frame are carried over, so the mix stays in step with the game.
+
+void SoundMixer::MixOffline(float delta)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    pendingFrames += (double) delta * offlineSampleRate;
+
+    while (pendingFrames >= 1.0)
+    {
+        ma_uint32 frameCount = (ma_uint32) Min(pendingFrames, (double) offlineChunkFrames);
+
+        pMusic->Fill();
+        Mix(offlineFrames.data(), frameCount);
+
+        if (pEncoder)
+        {
+            ma_encoder_write_pcm_frames(pEncoder.get(), offlineFrames.data(), frameCount, nullptr);
+        }
+
+        pendingFrames -= frameCount;
+        mixedFrames += frameCount;
+    }
+
+    mixTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+// Start a sound on one of its voices, without allocating;
+// When the sound's voices are all playing, its oldest voice is restarted.
+
+void SoundMixer::StartSound(VoicePool& pool, float volume)
+{
+    // Find a free voice, otherwise the oldest.
+
+    int voice = 0;
+    bool found = false;
+
+    for (int i = 0; i < pool.voiceCount && !found; i++)
+    {
+        found = !IsVoicePlaying(pool, i);
+
+        if (found || pool.pVoices[i].startOrder < pool.pVoices[voice].startOrder)
+        {
+            voice = i;
+        }
+    }
+
+    if (!found)
+    {
+        StartVoice(pool, voice, volume);
+
+        return;
+    }
+
+    // Count the playing voices and find the one to steal if there are too many;
+    // The lowest priority voice is stolen first, then the oldest.
+
+    int activeCount = 0;
+    VoicePool* pVictimPool = nullptr;
+    int victim = 0;
+
+    int publishedCount = soundCount.load(std::memory_order_acquire);
+
+    for (int sound = 0; sound < publishedCount; sound++)
+    {
+        VoicePool& other = sounds[sound];
+
+        for (int i = 0; i < other.voiceCount; i++)
+        {
+            if (!IsVoicePlaying(other, i))
+            {
+                continue;
+            }
+
+            activeCount++;
+
+            if (!pVictimPool || other.priority < pVictimPool->priority
+                || (other.priority == pVictimPool->priority && other.pVoices[i].startOrder < pVictimPool->pVoices[victim].startOrder))
+            {
+                pVictimPool = &other;
+                victim = i;
+            }
+        }
+    }
+
+    // Sounds cannot steal from higher priority sounds, so they are dropped instead.
+
+    if (activeCount >= maxActiveVoices)
+    {
+        if (pVictimPool->priority > pool.priority)
+        {
+            return;
+        }
+
+        ma_sound_stop(&pVictimPool->pVoices[victim].sound);
+    }
+
+    StartVoice(pool, voice, volume);
+}
+
+// Send a command to the audio thread, counting it as dropped if the queue is full.
+
+void SoundMixer::SendCommand(const Command& command)
+{
+    if (!commands.Push(command))
+    {
+        droppedCount++;
+    }
+}
+
+// Count the voices playing across every sound.
+
+int SoundMixer::CountActiveVoices() const
+{
+    int publishedCount = soundCount.load(std::memory_order_acquire);
+    int activeCount = 0;
+
+    for (int sound = 0; sound < publishedCount; sound++)
+    {
+        for (int i = 0; i < sounds[sound].voiceCount; i++)
+        {
+            activeCount += IsVoicePlaying(sounds[sound], i);
+        }
+    }
+
+    return activeCount;
+}
+
+// Check if a voice is still playing its sound.
+
+bool SoundMixer::IsVoicePlaying(const VoicePool& pool, int voice) const
+{
+    const ma_sound* pSound = &pool.pVoices[voice].sound;
+
+    return ma_sound_is_playing(pSound) && !ma_sound_at_end(pSound);
+}
+
+// Start a voice from the beginning of its sound at a volume.
+
+void SoundMixer::StartVoice(VoicePool& pool, int voice, float volume)
+{
+    ma_sound* pSound = &pool.pVoices[voice].sound;
+
+    ma_sound_set_volume(pSound, volume);
+    ma_sound_seek_to_pcm_frame(pSound, 0);
+    ma_sound_start(pSound);
+
+    pool.pVoices[voice].startOrder = ++playCount;
 }
\ No newline at end of file
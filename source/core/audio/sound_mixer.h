@@ -1,31 +1,179 @@
 #ifndef SOUND_MIXER_H
 #define SOUND_MIXER_H
 
+#include "command_queue.h"
 #include "sound.h"
+#include "sound_bank.h"
+#include <atomic>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <vector>
 
+class MusicStream;
+
+struct ma_device;
+struct ma_encoder;
 struct ma_engine;
-struct ma_sound;
 
 extern class SoundMixer* pSoundMixer;
 
+// Voices each sound has by default, the most a sound can have, and the most that can play at once.
+
+constexpr int defaultVoiceCount = 4;
+constexpr int maxVoiceCount = 8;
+constexpr int maxActiveVoices = 32;
+
+// Most sounds that can be loaded, and most commands that can wait for the audio thread.
+
+constexpr int maxSounds = 64;
+constexpr size_t soundCommandCapacity = 256;
+
+// Volume added for each extra play of a sound merged into the same tick, and its limit.
+
+constexpr float mergedVolumeStep = 0.25f;
+constexpr float maxMergedVolume = 2.0f;
+
+// Format of the mix rendered without a device.
+
+constexpr int offlineChannels = 2;
+constexpr int offlineSampleRate = 48000;
+
+// Health of the audio callback, measured on the audio thread.
+
+struct AudioHealth
+{
+    double mixTime;    // Average seconds spent mixing each buffer.
+    double bufferTime; // Average seconds of audio in each buffer.
+    double peakLoad;   // Most of a buffer's duration spent mixing it.
+    double outputLatency;
+
+    int activeVoices;
+    int peakVoices;
+    int underruns;
+    int overruns; // Buffers that took longer to mix than to play.
+    int droppedCommands;
+};
+
 class SoundMixer
 {
 public:
-    SoundMixer();
+    SoundMixer(int sampleRate = 0, int periodSize = 0, int periodCount = 0);
+    explicit SoundMixer(std::string_view outputPath);
     ~SoundMixer();
 
+    void Update(float delta);
+
+    double GetMixTime() const;
+    double GetMixedTime() const;
+
+    double GetOutputLatency() const;
+    int GetUnderrunCount() const;
+
+    AudioHealth GetHealth() const;
+    void RecordMetrics() const;
+
     void SetMasterVolume(float volume);
     void PlaySound(const Sound& sound);
+    void PlayMusic(std::string_view path);
 
-    Sound GetSound(std::string_view path);
+    Sound GetSound(std::string_view path, int voiceCount = defaultVoiceCount, int priority = 0, float cooldown = 0.0f);
 
 private:
+    // Request passed from the game thread to the audio thread.
+
+    enum CommandType
+    {
+        COMMAND_PLAY,
+        COMMAND_VOLUME
+    };
+
+    struct Command
+    {
+        CommandType type;
+        int sound;
+        float volume;
+        long long sendTime; // Microseconds on a steady clock, to measure latency.
+    };
+
+    // Voices of a sound, created with the sound bank and each reading its frames from it;
+    // Voices hold miniaudio types, so they are only defined where miniaudio is implemented.
+
+    struct Voice;
+
+    struct VoicePool
+    {
+        Voice* pVoices;
+
+        int voiceCount;
+        int priority;
+
+        float cooldown;
+        double lastPlayTime;
+        int queuedCount;
+    };
+
+    static void OnDeviceData(ma_device* pDevice, void* pOutput, const void* pInput, unsigned int frameCount);
+
+    void Initialise(int channels, int sampleRate);
+    void Mix(float* pOutput, unsigned int frameCount);
+    void MixOffline(float delta);
+    void StartSound(VoicePool& pool, float volume);
+    void SendCommand(const Command& command);
+    int CountActiveVoices() const;
+    bool IsVoicePlaying(const VoicePool& pool, int voice) const;
+    void StartVoice(VoicePool& pool, int voice, float volume);
+
+    std::unique_ptr<ma_device> pDevice;
     std::unique_ptr<ma_engine> pEngine;
-    std::vector<std::unique_ptr<ma_sound>> sounds;
+    std::unique_ptr<SoundBank> pBank;
+    std::unique_ptr<MusicStream, void (*)(MusicStream*)> pMusic;
+    float masterVolume;
+
+    // Voices of every sound in the bank, created up front so the game thread never creates them.
+
+    std::unique_ptr<Voice[], void (*)(Voice*)> pVoices;
+    std::vector<int> createdVoiceCounts;
+
+    // Measured by the audio thread, from the device's buffer and the time commands wait.
+
+    double bufferLatency;
+    long long lastCallbackTime;
+    std::atomic<long long> totalWaitTime;
+    std::atomic<int> waitCount;
+    std::atomic<int> underrunCount;
+
+    // Published by the audio thread after each buffer, without locking.
+
+    std::atomic<int> callbackCount;
+    std::atomic<long long> totalMixTime;
+    std::atomic<long long> totalBufferTime;
+    std::atomic<float> peakLoad;
+    std::atomic<int> overrunCount;
+    std::atomic<int> activeVoiceCount;
+    std::atomic<int> peakVoiceCount;
+
+    int droppedCount;
+
+    // Offline mixing renders frames in step with the game, optionally into a file.
+
+    bool offline;
+    std::unique_ptr<ma_encoder> pEncoder;
+    std::vector<float> offlineFrames;
+    double pendingFrames;
+    double mixTime;
+    unsigned long long mixedFrames;
+
+    // Sounds are published to the audio thread by their count, so they are never reallocated.
+
+    std::vector<VoicePool> sounds;
     std::vector<std::string_view> files;
+    std::atomic<int> soundCount;
+
+    CommandQueue<Command, soundCommandCapacity> commands;
+
+    unsigned long long playCount;
+    double time;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,340 @@
+#include "asset_pack.h"
+#include "core/hash.h"
+#include "core/logging.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+AssetPack* pAssetPack;
+
+// Pack format identification.
+
+constexpr char packMagic[4] = {'M', 'O', 'D', 'A'};
+constexpr int packVersion = 1;
+
+// Alignment of asset data within the pack, in bytes.
+
+constexpr size_t packAlignment = 16;
+
+// Fixed-size header at the start of a pack.
+
+struct PackHeader
+{
+    char magic[4];
+    int version;
+    int entryCount;
+    int namesSize;
+    unsigned long long fileSize;
+    unsigned long long checksum;
+};
+
+// Index entry locating one asset's data and path;
+// Entries are sorted by the hash of their path.
+
+struct PackEntry
+{
+    unsigned long long hash;
+    unsigned long long offset;
+    unsigned long long size;
+    int nameOffset;
+    int nameLength;
+};
+
+static_assert(sizeof(PackHeader) == 32, "Pack header must have no padding.");
+static_assert(sizeof(PackEntry) == 32, "Pack entry must have no padding.");
+
+// Round an offset up to the pack alignment.
+
+static size_t Align(size_t offset)
+{
+    return (offset + packAlignment - 1) / packAlignment * packAlignment;
+}
+
+// Map an asset pack and validate its index;
+// A missing or invalid pack leaves every asset to be loaded from loose files.
+
+AssetPack::AssetPack(std::string_view path)
+    : pEntries(nullptr), pNames(nullptr), entryCount(0)
+{
+    pAssetPack = this;
+
+    if (!file.Open(path))
+    {
+        LOG("No asset pack at \"" << path << "\", using loose files.");
+
+        return;
+    }
+
+    const unsigned char* pData = file.GetData();
+    size_t size = file.GetSize();
+
+    // Validate the header, then the index and names that follow it.
+
+    PackHeader header = {};
+    bool valid = size >= sizeof(PackHeader);
+
+    if (valid)
+    {
+        memcpy(&header, pData, sizeof(PackHeader));
+
+        valid = memcmp(header.magic, packMagic, 4) == 0 && header.version == packVersion
+             && header.fileSize == size && header.entryCount >= 0 && header.namesSize >= 0;
+    }
+
+    size_t indexSize = (size_t) header.entryCount * sizeof(PackEntry) + (size_t) header.namesSize;
+    valid = valid && indexSize <= size - sizeof(PackHeader)
+                  && Hash(pData + sizeof(PackHeader), indexSize) == header.checksum;
+
+    if (valid)
+    {
+        pEntries = (const PackEntry*) (pData + sizeof(PackHeader));
+        pNames = (const char*) (pEntries + header.entryCount);
+        entryCount = header.entryCount;
+    }
+
+    // Validate that every entry lies within the pack.
+
+    for (int i = 0; valid && i < entryCount; i++)
+    {
+        const PackEntry& entry = pEntries[i];
+
+        valid = entry.offset <= size && entry.size <= size - entry.offset && entry.nameOffset >= 0
+             && entry.nameLength >= 0 && entry.nameLength <= header.namesSize - entry.nameOffset
+             && (i == 0 || pEntries[i - 1].hash <= entry.hash);
+    }
+
+    if (!valid)
+    {
+        ERR("Asset pack \"" << path << "\" is invalid or corrupt, using loose files.");
+
+        file.Close();
+        pEntries = nullptr;
+        pNames = nullptr;
+        entryCount = 0;
+
+        return;
+    }
+
+    LOG("Opened asset pack \"" << path << "\" with " << entryCount << " assets.");
+}
+
+// Unmap the asset pack.
+
+AssetPack::~AssetPack()
+{
+    pAssetPack = nullptr;
+}
+
+// Check if the pack was opened and is valid.
+
+bool AssetPack::IsOpen() const
+{
+    return pEntries != nullptr;
+}
+
+// Find an asset's data in the pack by its path.
+
+bool AssetPack::Find(std::string_view path, const unsigned char*& outData, size_t& outSize) const
+{
+    unsigned long long hash = Hash(path.data(), path.size());
+
+    auto compare = [](const PackEntry& entry, unsigned long long value) { return entry.hash < value; };
+    const PackEntry* pEntry = std::lower_bound(pEntries, pEntries + entryCount, hash, compare);
+
+    // Compare the path of every entry with the same hash.
+
+    for (; pEntry != pEntries + entryCount && pEntry->hash == hash; pEntry++)
+    {
+        if (std::string_view(pNames + pEntry->nameOffset, pEntry->nameLength) == path)
+        {
+            outData = file.GetData() + pEntry->offset;
+            outSize = (size_t) pEntry->size;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// List the names of packed assets in a directory with an extension;
+// Names are returned sorted, without the directory or extension.
+
+std::vector<std::string> AssetPack::List(std::string_view directory, std::string_view extension) const
+{
+    std::vector<std::string> names;
+
+    for (int i = 0; i < entryCount; i++)
+    {
+        std::string_view path(pNames + pEntries[i].nameOffset, pEntries[i].nameLength);
+
+        if (path.size() > directory.size() + extension.size() && path.substr(0, directory.size()) == directory
+            && path.substr(path.size() - extension.size()) == extension)
+        {
+            path = path.substr(directory.size(), path.size() - directory.size() - extension.size());
+
+            if (path.find('/') == std::string_view::npos)
+            {
+                names.emplace_back(path);
+            }
+        }
+    }
+
+    std::sort(names.begin(), names.end());
+
+    return names;
+}
+
+// Initialise an unopened asset.
+
+Asset::Asset()
+    : pData(nullptr), size(0), packed(false)
+{}
+
+// Open an asset from the pack, or from a loose file if it is not packed.
+
+bool Asset::Open(std::string_view path)
+{
+    packed = pAssetPack && pAssetPack->Find(path, pData, size);
+
+    if (packed)
+    {
+        return true;
+    }
+
+    if (!file.Open(path))
+    {
+        pData = nullptr;
+        size = 0;
+
+        return false;
+    }
+
+    pData = file.GetData();
+    size = file.GetSize();
+
+    return true;
+}
+
+// Get the bytes of the asset.
+
+const unsigned char* Asset::GetData() const
+{
+    return pData;
+}
+
+// Get the size of the asset in bytes.
+
+size_t Asset::GetSize() const
+{
+    return size;
+}
+
+// Check if the asset was found in the pack.
+
+bool Asset::IsPacked() const
+{
+    return packed;
+}
+
+// Build an asset pack from loose files;
+// Each asset is stored under the path it was read from.
+
+bool SaveAssetPack(std::string_view path, const std::vector<std::string>& assetPaths)
+{
+    std::vector<std::vector<char>> contents(assetPaths.size());
+    std::vector<PackEntry> entries(assetPaths.size());
+    std::string names;
+
+    // Read every asset and record its path.
+
+    for (size_t i = 0; i < assetPaths.size(); i++)
+    {
+        std::ifstream file(assetPaths[i], std::ios::binary);
+
+        if (!file.is_open())
+        {
+            ERR("Failed to read asset \"" << assetPaths[i] << "\".");
+
+            return false;
+        }
+
+        contents[i].assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        entries[i].hash = Hash(assetPaths[i].data(), assetPaths[i].size());
+        entries[i].size = contents[i].size();
+        entries[i].nameOffset = (int) names.size();
+        entries[i].nameLength = (int) assetPaths[i].size();
+
+        names += assetPaths[i];
+    }
+
+    // Sort the index by hash, keeping each entry's contents alongside it.
+
+    std::vector<size_t> order(entries.size());
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return entries[a].hash < entries[b].hash; });
+
+    // Lay out the aligned asset data after the header, index and names.
+
+    PackHeader header = {};
+
+    memcpy(header.magic, packMagic, 4);
+    header.version = packVersion;
+    header.entryCount = (int) entries.size();
+    header.namesSize = (int) names.size();
+
+    std::vector<PackEntry> index;
+    size_t offset = Align(sizeof(PackHeader) + entries.size() * sizeof(PackEntry) + names.size());
+
+    for (size_t i : order)
+    {
+        index.push_back(entries[i]);
+        index.back().offset = offset;
+
+        offset = Align(offset + contents[i].size());
+    }
+
+    header.fileSize = offset;
+    header.checksum = Hash(index.data(), index.size() * sizeof(PackEntry));
+    header.checksum = Hash(names.data(), names.size(), header.checksum);
+
+    // Write the pack, padding each asset to the alignment.
+
+    std::ofstream file(path.data(), std::ios::binary);
+
+    if (!file.is_open())
+    {
+        ERR("Failed to save asset pack to \"" << path << "\".");
+
+        return false;
+    }
+
+    file.write((const char*) &header, sizeof(PackHeader));
+    file.write((const char*) index.data(), (std::streamsize) (index.size() * sizeof(PackEntry)));
+    file.write(names.data(), (std::streamsize) names.size());
+
+    const char padding[packAlignment] = {};
+    size_t position = sizeof(PackHeader) + index.size() * sizeof(PackEntry) + names.size();
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const std::vector<char>& data = contents[order[i]];
+
+        file.write(padding, (std::streamsize) (index[i].offset - position));
+        file.write(data.data(), (std::streamsize) data.size());
+
+        position = index[i].offset + data.size();
+    }
+
+    file.write(padding, (std::streamsize) (header.fileSize - position));
+
+    LOG("Saved asset pack to \"" << path << "\".");
+
+    return file.good();
+}
\ No newline at end of file
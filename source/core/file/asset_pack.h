@@ -0,0 +1,58 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include "mapped_file.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+extern class AssetPack* pAssetPack;
+
+struct PackEntry;
+
+// An archive of assets mapped into memory;
+// Entries are found by binary search of an index sorted by path hash.
+
+class AssetPack
+{
+public:
+    AssetPack(std::string_view path);
+    ~AssetPack();
+
+    bool IsOpen() const;
+    bool Find(std::string_view path, const unsigned char*& outData, size_t& outSize) const;
+    std::vector<std::string> List(std::string_view directory, std::string_view extension) const;
+
+private:
+    MappedFile file;
+
+    const PackEntry* pEntries;
+    const char* pNames;
+    int entryCount;
+};
+
+// A read-only asset, found in the asset pack or mapped from a loose file;
+// Loose files are used when no pack is open or the pack lacks the path.
+
+class Asset
+{
+public:
+    Asset();
+
+    bool Open(std::string_view path);
+
+    const unsigned char* GetData() const;
+    size_t GetSize() const;
+    bool IsPacked() const;
+
+private:
+    MappedFile file;
+
+    const unsigned char* pData;
+    size_t size;
+    bool packed;
+};
+
+bool SaveAssetPack(std::string_view path, const std::vector<std::string>& assetPaths);
+
+#endif
\ No newline at end of file
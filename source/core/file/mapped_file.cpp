@@ -0,0 +1,133 @@
+#include "mapped_file.h"
+#include "core/logging.h"
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Initialise an unmapped file.
+
+MappedFile::MappedFile()
+    : pData(nullptr), size(0)
+{}
+
+// Unmap the file.
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+// Map a whole file into memory for reading;
+// The file itself is closed once mapped, only the view is kept.
+
+bool MappedFile::Open(std::string_view path)
+{
+    Close();
+
+    std::string pathString(path);
+
+#ifdef _WIN32
+
+    HANDLE file = CreateFileA(pathString.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize = {};
+    GetFileSizeEx(file, &fileSize);
+    size = (size_t) fileSize.QuadPart;
+
+    // Empty files cannot be mapped but are still valid.
+
+    if (size > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping)
+        {
+            pData = (const unsigned char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+
+    CloseHandle(file);
+
+#else
+
+    int file = open(pathString.c_str(), O_RDONLY);
+
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat status = {};
+    fstat(file, &status);
+    size = (size_t) status.st_size;
+
+    // Empty files cannot be mapped but are still valid.
+
+    if (size > 0)
+    {
+        void* pMapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        pData = (pMapping != MAP_FAILED) ? (const unsigned char*) pMapping : nullptr;
+    }
+
+    close(file);
+
+#endif
+
+    if (size > 0 && !pData)
+    {
+        ERR("Failed to map \"" << path << "\" into memory.");
+
+        size = 0;
+
+        return false;
+    }
+
+    return true;
+}
+
+// Unmap the file if one is mapped.
+
+void MappedFile::Close()
+{
+    if (pData)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(pData);
+#else
+        munmap((void*) pData, size);
+#endif
+    }
+
+    pData = nullptr;
+    size = 0;
+}
+
+// Get the mapped bytes of the file.
+
+const unsigned char* MappedFile::GetData() const
+{
+    return pData;
+}
+
+// Get the size of the file in bytes.
+
+size_t MappedFile::GetSize() const
+{
+    return size;
+}
\ No newline at end of file
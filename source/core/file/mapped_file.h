@@ -0,0 +1,29 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string_view>
+
+// A read-only file mapped into memory.
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(std::string_view path);
+    void Close();
+
+    const unsigned char* GetData() const;
+    size_t GetSize() const;
+
+private:
+    const unsigned char* pData;
+    size_t size;
+};
+
+#endif
\ No newline at end of file
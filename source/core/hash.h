@@ -0,0 +1,26 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+
+// FNV-1a offset basis, used as the initial hash value.
+
+constexpr unsigned long long hashBasis = 14695981039346656037ull;
+
+// Hash a block of bytes (64-bit FNV-1a);
+// Pass a previous hash to continue hashing across blocks.
+
+inline unsigned long long Hash(const void* pData, size_t size, unsigned long long hash = hashBasis)
+{
+    const unsigned char* pBytes = (const unsigned char*) pData;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= pBytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+#endif
\ No newline at end of file
@@ -119,4 +119,8 @@ enum Button
     KEY_MENU = 348
 };
 
+// Number of button codes, for tables indexed by button.
+
+constexpr int buttonCount = KEY_MENU + 1;
+
 #endif
\ No newline at end of file
@@ -9,54 +9,138 @@ Controller::Controller()
 {
     pController = this;
 
+    events.reserve(inputEventReserve);
+
     LOG("Initialised the Controller.");
 }
 
-// Update the state of a button.
+// Finish a simulation tick;
+// Presses and releases are reported for the single tick after they happen.
+
+void Controller::Update()
+{
+    previousStates = currentStates;
+}
+
+// Apply the queued input events received up to a time, in the order they were received;
+// Each button changes at most once per tick, so a press and release within a tick are both seen.
+
+void Controller::ProcessEvents(double time)
+{
+    std::bitset<buttonCount> changedStates;
+    size_t count = 0;
+
+    for (; count < events.size(); count++)
+    {
+        const Event& event = events[count];
+
+        if (event.time > time)
+        {
+            break;
+        }
+
+        if (event.type == EVENT_MOUSE)
+        {
+            mousePosition = event.position;
+
+            continue;
+        }
+
+        // Leave a second change of a button, and the events after it, for the next tick.
+
+        bool held = event.action == PRESS;
+
+        if (event.action == REPEAT || held == currentStates[event.button])
+        {
+            continue;
+        }
+
+        if (changedStates[event.button])
+        {
+            break;
+        }
+
+        currentStates.set(event.button, held);
+        changedStates.set(event.button);
+    }
+
+    events.erase(events.begin(), events.begin() + (std::ptrdiff_t) count);
+}
+
+// Queue a button action received at a time;
+// Buttons outside the known range, such as unknown keys, are ignored.
+
+void Controller::QueueButtonAction(Button button, Action action, double time)
+{
+    if (button < 0 || button >= buttonCount)
+    {
+        return;
+    }
+
+    events.push_back({EVENT_BUTTON, button, action, vector2f(), time});
+}
+
+// Queue a screen-space mouse position received at a time.
+
+void Controller::QueueMousePosition(vector2f position, double time)
+{
+    events.push_back({EVENT_MOUSE, MOUSE_LEFT, RELEASE, position, time});
+}
+
+// Update the state of a button immediately, as scripted and replayed input does;
+// Buttons outside the known range, such as unknown keys, are ignored.
 
 void Controller::OnButtonAction(Button button, Action action)
 {
+    if (button < 0 || button >= buttonCount)
+    {
+        return;
+    }
+
     if (action == PRESS)
     {
-        buttonStates[button] = true;
+        currentStates.set(button);
     }
     else if (action == RELEASE)
     {
-        buttonStates.erase(button);
+        currentStates.reset(button);
     }
 }
 
-// Update the screen-space mouse position.
+// Update the screen-space mouse position immediately.
 
 void Controller::OnMousePosition(vector2f position)
 {
     mousePosition = position;
 }
 
-// Check if a button is held down.
+// Set whether a button was held down as of the previous tick;
+// Used to reproduce recorded presses that a menu consumed.
 
-bool Controller::IsHeldDown(Button button) const
+void Controller::SetPreviouslyHeld(Button button, bool held)
 {
-    return buttonStates.find(button) != buttonStates.end();
+    previousStates.set(button, held);
 }
 
-// Check if a button was just pressed.
+// Check if a button is held down.
 
-bool Controller::WasPressed(Button button)
+bool Controller::IsHeldDown(Button button) const
 {
-    if (buttonStates.find(button) != buttonStates.end())
-    {
-        // Return and update the button's 'just pressed' state.
+    return currentStates[button];
+}
 
-        bool wasPressed = buttonStates[button];
-        buttonStates[button] = false;
+// Check if a button was pressed since the previous tick.
 
-        return wasPressed;
-    }
+bool Controller::WasPressed(Button button) const
+{
+    return currentStates[button] && !previousStates[button];
+}
 
-    // The button is not being held down.
+// Check if a button was released since the previous tick.
 
-    return false;
+bool Controller::WasReleased(Button button) const
+{
+    return !currentStates[button] && previousStates[button];
 }
 
 // Get the screen-space mouse position.
@@ -4,25 +4,60 @@
 #include "action.h"
 #include "button.h"
 #include "core/maths/maths.h"
-#include <unordered_map>
+#include <bitset>
+#include <vector>
 
 extern class Controller* pController;
 
+// Input events reserved up front, so queueing them does not normally allocate.
+
+constexpr int inputEventReserve = 64;
+
 class Controller
 {
 public:
     Controller();
 
+    void Update();
+    void ProcessEvents(double time);
+
+    void QueueButtonAction(Button button, Action action, double time);
+    void QueueMousePosition(vector2f position, double time);
+
     void OnButtonAction(Button button, Action action);
     void OnMousePosition(vector2f position);
+    void SetPreviouslyHeld(Button button, bool held);
 
     bool IsHeldDown(Button button) const;
-    bool WasPressed(Button button);
+    bool WasPressed(Button button) const;
+    bool WasReleased(Button button) const;
     vector2f GetMousePosition() const;
 
 private:
-    std::unordered_map<Button, bool> buttonStates;
+    // Input received from the window, applied when the simulation reaches its time.
+
+    enum EventType
+    {
+        EVENT_BUTTON,
+        EVENT_MOUSE
+    };
+
+    struct Event
+    {
+        EventType type;
+        Button button;
+        Action action;
+        vector2f position;
+        double time; // Seconds on the game's clock.
+    };
+
+    // Buttons held down now and as of the previous tick, indexed by button code.
+
+    std::bitset<buttonCount> currentStates;
+    std::bitset<buttonCount> previousStates;
     vector2f mousePosition;
+
+    std::vector<Event> events;
 };
 
 #endif
\ No newline at end of file
@@ -13,12 +13,14 @@
 #define ERR(string) std::cerr << string << std::endl
 #define START_METRIC(name) StartMetric(name)
 #define STOP_METRIC(name) StopMetric(name)
+#define SET_METRIC_VALUE(name, value) SetMetricValue(name, value)
 #define SAVE_METRICS(path) SaveMetrics(path)
 
-// Maps to keep track of timers and metrics.
+// Maps to keep track of timers, metrics, and values measured elsewhere.
 
 inline std::unordered_map<std::string_view, std::chrono::time_point<std::chrono::high_resolution_clock>> timers;
 inline std::unordered_map<std::string_view, struct Metric> metrics;
+inline std::unordered_map<std::string_view, double> metricValues;
 
 struct Metric
 {
@@ -67,6 +69,13 @@ inline void StopMetric(std::string_view name)
     timers.erase(name);
 }
 
+// Set a metric that is measured rather than timed, replacing its previous value.
+
+inline void SetMetricValue(std::string_view name, double value)
+{
+    metricValues[name] = value;
+}
+
 // Save all performance metrics to a file.
 
 inline void SaveMetrics(std::string_view path)
@@ -83,6 +92,11 @@ inline void SaveMetrics(std::string_view path)
 
         file << name << ": " << averageTime << "ms (" << metric.totalSamples << " samples)" << std::endl;
     }
+
+    for (auto[name, value] : metricValues)
+    {
+        file << name << ": " << value << std::endl;
+    }
 }
 
 #else
@@ -91,6 +105,7 @@ inline void SaveMetrics(std::string_view path)
 #define ERR(string)
 #define START_METRIC(name)
 #define STOP_METRIC(name)
+#define SET_METRIC_VALUE(name, value)
 #define SAVE_METRICS(path)
 
 #endif
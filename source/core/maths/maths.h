@@ -13,7 +13,7 @@ constexpr float epsilon = 0.0001f;   // Small float for comparisons.
 // Get the maximum of two values.
 
 template<typename T>
-inline T Max(T first, T second)
+constexpr T Max(T first, T second)
 {
     return (first > second) ? first : second;
 }
@@ -21,7 +21,7 @@ inline T Max(T first, T second)
 // Get the minimum of two values.
 
 template<typename T>
-inline T Min(T first, T second)
+constexpr T Min(T first, T second)
 {
     return (first < second) ? first : second;
 }
@@ -29,15 +29,22 @@ inline T Min(T first, T second)
 // Clamp a value to a range.
 
 template<typename T>
-inline T Clamp(T value, T min, T max)
+constexpr T Clamp(T value, T min, T max)
 {
     return Max(Min(value, max), min);
 }
 
+// Get the absolute value of a float.
+
+constexpr float Abs(float value)
+{
+    return (value < 0.0f) ? -value : value;
+}
+
 // Linearly interpolate between two values.
 
 template<typename T>
-inline T Lerp(T start, T end, float value)
+constexpr T Lerp(T start, T end, float value)
 {
     return start + (end - start) * Min(value, 1.0f);
 }
@@ -49,47 +56,316 @@ inline float Snap(float value, float step)
     return roundf(value / step) * step;
 }
 
+// Get the sine of an angle in degrees;
+// A polynomial that gives the same result on every platform.
+
+constexpr float Sine(float angle)
+{
+    // Wrap the angle to a range of -180 to 180, then fold it to -90 to 90.
+
+    float turns = angle / 360.0f;
+    angle -= (float) (int) (turns + (turns >= 0.0f ? 0.5f : -0.5f)) * 360.0f;
+
+    if (angle > 90.0f)
+    {
+        angle = 180.0f - angle;
+    }
+    else if (angle < -90.0f)
+    {
+        angle = -180.0f - angle;
+    }
+
+    // Evaluate the Taylor series up to the 11th power.
+
+    float x = angle * 0.017453293f;
+    float x2 = x * x;
+
+    return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f
+             + x2 * (1.0f / 362880.0f + x2 * (-1.0f / 39916800.0f))))));
+}
+
+// Get the cosine of an angle in degrees.
+
+constexpr float Cosine(float angle)
+{
+    return Sine(angle + 90.0f);
+}
+
+// Get the angle in radians of a point from the origin, like atan2;
+// A polynomial accurate to about 0.00001 radians.
+
+constexpr float ArcTangent(float y, float x)
+{
+    float absoluteX = Abs(x);
+    float absoluteY = Abs(y);
+
+    if (absoluteX == 0.0f && absoluteY == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    // Approximate the angle within the first octant, then reflect it.
+
+    bool steep = absoluteY > absoluteX;
+    float z = steep ? absoluteX / absoluteY : absoluteY / absoluteX;
+    float z2 = z * z;
+
+    float angle = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+
+    if (steep)
+    {
+        angle = pi * 0.5f - angle;
+    }
+
+    if (x < 0.0f)
+    {
+        angle = pi - angle;
+    }
+
+    return (y < 0.0f) ? -angle : angle;
+}
+
 // Two-component float vector.
 
 struct vector2f
 {
 public:
-    vector2f();
-    vector2f(float x, float y);
+    constexpr vector2f();
+    constexpr vector2f(float x, float y);
 
-    bool IsZero() const;
-    bool IsNearlyZero() const;
+    constexpr bool IsZero() const;
+    constexpr bool IsNearlyZero() const;
 
     float Length() const;
-    float SqrLength() const;
-    float Rotation() const;
+    constexpr float SqrLength() const;
+    constexpr float Rotation() const;
+    constexpr int Octant() const;
 
     vector2f Normalised() const;
-    vector2f Rotated(float angle) const;
-    vector2f operator-() const;
+    constexpr vector2f Rotated(float angle) const;
+    constexpr vector2f operator-() const;
 
-    vector2f operator+(const vector2f& other) const;
-    vector2f operator-(const vector2f& other) const;
-    vector2f operator*(const vector2f& other) const;
-    vector2f operator/(const vector2f& other) const;
+    constexpr vector2f operator+(const vector2f& other) const;
+    constexpr vector2f operator-(const vector2f& other) const;
+    constexpr vector2f operator*(const vector2f& other) const;
+    constexpr vector2f operator/(const vector2f& other) const;
 
-    vector2f operator*(float value) const;
-    vector2f operator/(float value) const;
+    constexpr vector2f operator*(float value) const;
+    constexpr vector2f operator/(float value) const;
 
-    vector2f& operator=(const vector2f& other);
-    vector2f& operator+=(const vector2f& other);
-    vector2f& operator-=(const vector2f& other);
-    vector2f& operator*=(const vector2f& other);
-    vector2f& operator/=(const vector2f& other);
+    constexpr vector2f& operator=(const vector2f& other) = default;
+    constexpr vector2f& operator+=(const vector2f& other);
+    constexpr vector2f& operator-=(const vector2f& other);
+    constexpr vector2f& operator*=(const vector2f& other);
+    constexpr vector2f& operator/=(const vector2f& other);
 
-    vector2f& operator*=(float value);
-    vector2f& operator/=(float value);
+    constexpr vector2f& operator*=(float value);
+    constexpr vector2f& operator/=(float value);
 
 public:
     float x, y;
 
 public:
-    static vector2f zero;
+    static const vector2f zero;
 };
 
+// Create a vector.
+
+constexpr vector2f::vector2f()
+    : x(0.0f), y(0.0f)
+{}
+
+constexpr vector2f::vector2f(float x, float y)
+    : x(x), y(y)
+{}
+
+inline constexpr vector2f vector2f::zero = vector2f();
+
+// Check if this vector is zero.
+
+constexpr bool vector2f::IsZero() const
+{
+    return x == 0.0f && y == 0.0f;
+}
+
+// Check if this vector is nearly zero.
+
+constexpr bool vector2f::IsNearlyZero() const
+{
+    return Abs(x) < epsilon && Abs(y) < epsilon;
+}
+
+// Get this vector's length.
+
+inline float vector2f::Length() const
+{
+    return sqrtf(x * x + y * y);
+}
+
+// Get this vector's squared length.
+
+constexpr float vector2f::SqrLength() const
+{
+    return x * x + y * y;
+}
+
+// Get this vector's angle in degrees.
+
+constexpr float vector2f::Rotation() const
+{
+    float angle = ArcTangent(y, x) * radian;
+
+    // Return the rotation normalised to a range of 0-360.
+
+    return angle >= 0 ? angle : angle + 360.0f;
+}
+
+// Get which of eight 45 degree sectors this vector points into;
+// Sector 0 is centred on the positive x axis, counting anticlockwise.
+
+constexpr int vector2f::Octant() const
+{
+    constexpr float tangent = 0.41421356f; // Tangent of 22.5 degrees.
+
+    float absoluteX = Abs(x);
+    float absoluteY = Abs(y);
+
+    // Compare the sides against the sector edges instead of finding the angle.
+
+    if (absoluteY <= absoluteX * tangent)
+    {
+        return (x >= 0.0f) ? 0 : 4;
+    }
+
+    if (absoluteX <= absoluteY * tangent)
+    {
+        return (y > 0.0f) ? 2 : 6;
+    }
+
+    if (y > 0.0f)
+    {
+        return (x > 0.0f) ? 1 : 3;
+    }
+
+    return (x > 0.0f) ? 7 : 5;
+}
+
+// Derive a normalised vector.
+
+inline vector2f vector2f::Normalised() const
+{
+    if (IsZero())
+    {
+        return vector2f::zero;
+    }
+
+    // If not zero, return the normal of this vector.
+
+    float length = Length();
+
+    return {x / length, y / length};
+}
+
+// Derive a rotated vector.
+
+constexpr vector2f vector2f::Rotated(float angle) const
+{
+    float sine = Sine(angle);
+    float cosine = Cosine(angle);
+
+    vector2f a(cosine, sine);
+    vector2f b(-sine, cosine);
+
+    return a * x + b * y;
+}
+
+// Derive an inverted vector.
+
+constexpr vector2f vector2f::operator-() const
+{
+    return {-x, -y};
+}
+
+// Binary arithmetic operators.
+
+constexpr vector2f vector2f::operator+(const vector2f& other) const
+{
+    return {x + other.x, y + other.y};
+}
+
+constexpr vector2f vector2f::operator-(const vector2f& other) const
+{
+    return {x - other.x, y - other.y};
+}
+
+constexpr vector2f vector2f::operator*(const vector2f& other) const
+{
+    return {x * other.x, y * other.y};
+}
+
+constexpr vector2f vector2f::operator/(const vector2f& other) const
+{
+    return {x / other.x, y / other.y};
+}
+
+constexpr vector2f vector2f::operator*(float value) const
+{
+    return {x * value, y * value};
+}
+
+constexpr vector2f vector2f::operator/(float value) const
+{
+    return {x / value, y / value};
+}
+
+// Assignment operators.
+
+constexpr vector2f& vector2f::operator+=(const vector2f& other)
+{
+    x += other.x;
+    y += other.y;
+
+    return *this;
+}
+
+constexpr vector2f& vector2f::operator-=(const vector2f& other)
+{
+    x -= other.x;
+    y -= other.y;
+
+    return *this;
+}
+
+constexpr vector2f& vector2f::operator*=(const vector2f& other)
+{
+    x *= other.x;
+    y *= other.y;
+
+    return *this;
+}
+
+constexpr vector2f& vector2f::operator/=(const vector2f& other)
+{
+    x /= other.x;
+    y /= other.y;
+
+    return *this;
+}
+
+constexpr vector2f& vector2f::operator*=(float value)
+{
+    x *= value;
+    y *= value;
+
+    return *this;
+}
+
+constexpr vector2f& vector2f::operator/=(float value)
+{
+    x /= value;
+    y /= value;
+
+    return *this;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,248 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "maths.h"
+
+// Select an instruction set for four-wide float operations;
+// MATHS_SIMD is left undefined when neither SSE2 nor NEON is available.
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define MATHS_SIMD
+#define MATHS_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MATHS_SIMD
+#define MATHS_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef MATHS_SIMD
+
+// Four floats processed together;
+// Comparisons return lanes with every bit set or clear.
+
+struct float4
+{
+#ifdef MATHS_SSE2
+    __m128 value;
+#else
+    float32x4_t value;
+#endif
+};
+
+#ifdef MATHS_SSE2
+
+// Load, store and broadcast.
+
+inline float4 Load4(const float* pValues) { return {_mm_loadu_ps(pValues)}; }
+inline void Store4(float* pValues, float4 a) { _mm_storeu_ps(pValues, a.value); }
+inline float4 Splat4(float value) { return {_mm_set1_ps(value)}; }
+
+// Arithmetic.
+
+inline float4 operator+(float4 a, float4 b) { return {_mm_add_ps(a.value, b.value)}; }
+inline float4 operator-(float4 a, float4 b) { return {_mm_sub_ps(a.value, b.value)}; }
+inline float4 operator*(float4 a, float4 b) { return {_mm_mul_ps(a.value, b.value)}; }
+inline float4 operator/(float4 a, float4 b) { return {_mm_div_ps(a.value, b.value)}; }
+
+// Comparisons and bitwise logic.
+
+inline float4 operator<(float4 a, float4 b) { return {_mm_cmplt_ps(a.value, b.value)}; }
+inline float4 operator>(float4 a, float4 b) { return {_mm_cmpgt_ps(a.value, b.value)}; }
+inline float4 operator>=(float4 a, float4 b) { return {_mm_cmpge_ps(a.value, b.value)}; }
+inline float4 operator&(float4 a, float4 b) { return {_mm_and_ps(a.value, b.value)}; }
+inline float4 operator|(float4 a, float4 b) { return {_mm_or_ps(a.value, b.value)}; }
+
+// Choose between two vectors per lane with a comparison mask.
+
+inline float4 Select4(float4 mask, float4 first, float4 second)
+{
+    return {_mm_or_ps(_mm_and_ps(mask.value, first.value), _mm_andnot_ps(mask.value, second.value))};
+}
+
+// Get a bit for each lane of a mask, lane 0 in the lowest bit.
+
+inline int Mask4(float4 mask)
+{
+    return _mm_movemask_ps(mask.value);
+}
+
+// Get the absolute value of each lane.
+
+inline float4 Abs4(float4 a)
+{
+    return {_mm_and_ps(a.value, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)))};
+}
+
+// Round each lane down to a whole number.
+
+inline float4 Floor4(float4 a)
+{
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.value));
+
+    return {_mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.value), _mm_set1_ps(1.0f)))};
+}
+
+// Round each lane up to a whole number.
+
+inline float4 Ceil4(float4 a)
+{
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.value));
+
+    return {_mm_add_ps(truncated, _mm_and_ps(_mm_cmplt_ps(truncated, a.value), _mm_set1_ps(1.0f)))};
+}
+
+// Interleave the lanes of two vectors into eight floats.
+
+inline void StoreInterleaved4(float* pValues, float4 a, float4 b)
+{
+    _mm_storeu_ps(pValues, _mm_unpacklo_ps(a.value, b.value));
+    _mm_storeu_ps(pValues + 4, _mm_unpackhi_ps(a.value, b.value));
+}
+
+#else
+
+// Load, store and broadcast.
+
+inline float4 Load4(const float* pValues) { return {vld1q_f32(pValues)}; }
+inline void Store4(float* pValues, float4 a) { vst1q_f32(pValues, a.value); }
+inline float4 Splat4(float value) { return {vdupq_n_f32(value)}; }
+
+// Arithmetic.
+
+inline float4 operator+(float4 a, float4 b) { return {vaddq_f32(a.value, b.value)}; }
+inline float4 operator-(float4 a, float4 b) { return {vsubq_f32(a.value, b.value)}; }
+inline float4 operator*(float4 a, float4 b) { return {vmulq_f32(a.value, b.value)}; }
+inline float4 operator/(float4 a, float4 b) { return {vdivq_f32(a.value, b.value)}; }
+
+// Comparisons and bitwise logic.
+
+inline float4 operator<(float4 a, float4 b) { return {vreinterpretq_f32_u32(vcltq_f32(a.value, b.value))}; }
+inline float4 operator>(float4 a, float4 b) { return {vreinterpretq_f32_u32(vcgtq_f32(a.value, b.value))}; }
+inline float4 operator>=(float4 a, float4 b) { return {vreinterpretq_f32_u32(vcgeq_f32(a.value, b.value))}; }
+
+inline float4 operator&(float4 a, float4 b)
+{
+    return {vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.value), vreinterpretq_u32_f32(b.value)))};
+}
+
+inline float4 operator|(float4 a, float4 b)
+{
+    return {vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.value), vreinterpretq_u32_f32(b.value)))};
+}
+
+// Choose between two vectors per lane with a comparison mask.
+
+inline float4 Select4(float4 mask, float4 first, float4 second)
+{
+    return {vbslq_f32(vreinterpretq_u32_f32(mask.value), first.value, second.value)};
+}
+
+// Get a bit for each lane of a mask, lane 0 in the lowest bit.
+
+inline int Mask4(float4 mask)
+{
+    constexpr uint32_t weights[4] = {1, 2, 4, 8};
+    uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(mask.value), 31);
+
+    return (int) vaddvq_u32(vmulq_u32(bits, vld1q_u32(weights)));
+}
+
+// Get the absolute value of each lane.
+
+inline float4 Abs4(float4 a)
+{
+    return {vabsq_f32(a.value)};
+}
+
+// Round each lane down to a whole number.
+
+inline float4 Floor4(float4 a)
+{
+    return {vrndmq_f32(a.value)};
+}
+
+// Round each lane up to a whole number.
+
+inline float4 Ceil4(float4 a)
+{
+    return {vrndpq_f32(a.value)};
+}
+
+// Interleave the lanes of two vectors into eight floats.
+
+inline void StoreInterleaved4(float* pValues, float4 a, float4 b)
+{
+    float32x4x2_t pair = {{a.value, b.value}};
+    vst2q_f32(pValues, pair);
+}
+
+#endif
+
+#endif
+
+// Interpolate arrays of positions into a vector array;
+// The offset is added to every interpolated position.
+
+inline void LerpPositions(const float* pStartX, const float* pStartY, const float* pEndX, const float* pEndY,
+                          int count, float alpha, vector2f offset, vector2f* pOut)
+{
+    float fraction = Min(alpha, 1.0f);
+    int i = 0;
+
+#ifdef MATHS_SIMD
+
+    float4 fractions = Splat4(fraction);
+    float4 offsetX = Splat4(offset.x);
+    float4 offsetY = Splat4(offset.y);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        float4 startX = Load4(pStartX + i);
+        float4 startY = Load4(pStartY + i);
+        float4 x = startX + (Load4(pEndX + i) - startX) * fractions + offsetX;
+        float4 y = startY + (Load4(pEndY + i) - startY) * fractions + offsetY;
+
+        StoreInterleaved4(&pOut[i].x, x, y);
+    }
+
+#endif
+
+    for (; i < count; i++)
+    {
+        pOut[i].x = pStartX[i] + (pEndX[i] - pStartX[i]) * fraction + offset.x;
+        pOut[i].y = pStartY[i] + (pEndY[i] - pStartY[i]) * fraction + offset.y;
+    }
+}
+
+// Damp arrays of velocities towards zero by a fraction, like Lerp to zero.
+
+inline void DampVelocities(float* pVelocityX, float* pVelocityY, int count, float fraction)
+{
+    fraction = Min(fraction, 1.0f);
+    int i = 0;
+
+#ifdef MATHS_SIMD
+
+    float4 zero = Splat4(0.0f);
+    float4 fractions = Splat4(fraction);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        float4 x = Load4(pVelocityX + i);
+        float4 y = Load4(pVelocityY + i);
+
+        Store4(pVelocityX + i, x + (zero - x) * fractions);
+        Store4(pVelocityY + i, y + (zero - y) * fractions);
+    }
+
+#endif
+
+    for (; i < count; i++)
+    {
+        pVelocityX[i] += (0.0f - pVelocityX[i]) * fraction;
+        pVelocityY[i] += (0.0f - pVelocityY[i]) * fraction;
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "image.h"
+#include "core/file/asset_pack.h"
+#include "core/logging.h"
+#include "core/maths/maths.h"
+#include <cstring>
+
+// Load a bitmap image from the asset pack or a file;
+// Safe to call from any thread.
+
+bool LoadImageFile(std::string_view path, Image& outImage)
+{
+    Asset file;
+    outImage = {0, 0, {}};
+
+    // Validate that the file was opened and holds its header.
+
+    if (!file.Open(path) || file.GetSize() < 26)
+    {
+        ERR("Failed to load image from \"" << path << "\".");
+
+        return false;
+    }
+
+    // Read the pixel starting offset and the image's dimensions.
+
+    const unsigned char* pData = file.GetData();
+    int pixelOffset, width, height;
+
+    memcpy(&pixelOffset, pData + 10, 4);
+    memcpy(&width, pData + 18, 4);
+    memcpy(&height, pData + 22, 4);
+
+    // Validate that the pixel data is within the file.
+
+    size_t pixelCount = (size_t) Max(width, 0) * (size_t) Max(height, 0);
+
+    if (pixelOffset < 26 || (size_t) pixelOffset > file.GetSize() || pixelCount > (file.GetSize() - pixelOffset) / 4)
+    {
+        ERR("Image \"" << path << "\" is invalid or corrupt.");
+
+        return false;
+    }
+
+    // Read the image's pixel data.
+
+    std::vector<unsigned char>& pixels = outImage.pixels;
+    const unsigned char* pPixel = pData + pixelOffset;
+
+    pixels.resize(pixelCount * 4);
+
+    for (size_t i = 0; i < pixelCount; i++, pPixel += 4)
+    {
+        pixels[i * 4] = pPixel[2];
+        pixels[i * 4 + 1] = pPixel[1];
+        pixels[i * 4 + 2] = pPixel[0];
+        pixels[i * 4 + 3] = pPixel[3];
+    }
+
+    outImage.width = width;
+    outImage.height = height;
+
+    LOG("Loaded image from \"" << path << "\".");
+
+    return true;
+}
\ No newline at end of file
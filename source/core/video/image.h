@@ -0,0 +1,19 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <string_view>
+#include <vector>
+
+// Decoded RGBA pixels of an image, stored from the bottom row up.
+
+struct Image
+{
+    int width;
+    int height;
+
+    std::vector<unsigned char> pixels;
+};
+
+bool LoadImageFile(std::string_view path, Image& outImage);
+
+#endif
\ No newline at end of file
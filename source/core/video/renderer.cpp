@@ -1,90 +1,32 @@
 #define GLFW_INCLUDE_NONE
 
 #include "renderer.h"
+#include "core/file/asset_pack.h"
 #include "core/logging.h"
 #include "glad/gl.h"
 #include "glfw/glfw3.h"
-#include <fstream>
 #include <string>
 
 Renderer* pRenderer;
 
-// Load shader string from a file.
+// Load shader string from the asset pack or a file.
 
 static std::string LoadShaderFile(std::string_view path)
 {
-    std::ifstream file(path.data());
+    Asset file;
 
     // Validate that the file was opened.
 
-    if (!file.is_open())
+    if (!file.Open(path))
     {
         ERR("Failed to load shader from \"" << path << "\".");
 
         return {};
     }
 
-    // Read the file into a string.
-
-    std::string source;
-    std::string line;
-
-    while (std::getline(file, line))
-    {
-        source += line + '\n';
-    }
-
     LOG("Loaded shader from \"" << path << "\".");
 
-    return std::move(source);
-}
-
-// Load a bitmap image from a file.
-
-static std::vector<unsigned char> LoadImageFile(std::string_view path, int& outWidth, int& outHeight)
-{
-    std::ifstream file(path.data(), std::ios::binary);
-
-    // Validate that the file was opened.
-
-    if (!file.is_open())
-    {
-        ERR("Failed to load image from \"" << path << "\".");
-
-        return {};
-    }
-
-    // Read the pixel starting offset.
-
-    int pixelOffset;
-    file.ignore(10);
-    file.read((char*) &pixelOffset, 4);
-    file.ignore(4);
-
-    // Read the image's dimensions.
-
-    file.read((char*) &outWidth, 4);
-    file.read((char*) &outHeight, 4);
-    file.ignore(pixelOffset - 26);
-
-    // Read the image's pixel data.
-
-    std::vector<unsigned char> pixels(outWidth * outHeight * 4);
-
-    for (int i = 0; i < outWidth * outHeight; i++)
-    {
-        unsigned char pixel[4];
-        file.read((char*) pixel, 4);
-
-        pixels[i * 4] = pixel[2];
-        pixels[i * 4 + 1] = pixel[1];
-        pixels[i * 4 + 2] = pixel[0];
-        pixels[i * 4 + 3] = pixel[3];
-    }
-
-    LOG("Loaded image from \"" << path << "\".");
-
-    return std::move(pixels);
+    return std::string((const char*) file.GetData(), file.GetSize());
 }
 
 // Initialise the renderer.
@@ -134,6 +76,16 @@ Renderer::Renderer(std::string_view vertexPath, std::string_view fragmentPath)
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 5, (void*) (sizeof(float) * 3));
     glEnableVertexAttribArray(1);
 
+    // Create the per-instance offset buffer used for batched sprites;
+    // It stays disabled so single sprites read a zero offset.
+
+    glGenBuffers(1, &instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, nullptr);
+    glVertexAttribDivisor(2, 1);
+    glVertexAttrib2f(2, 0.0f, 0.0f);
+
     // Bind the vertex array object (VAO).
 
     glBindVertexArray(0);
@@ -188,6 +140,7 @@ Renderer::~Renderer()
     glDeleteVertexArrays(1, &vertexArray);
     glDeleteBuffers(1, &vertexBuffer);
     glDeleteBuffers(1, &indexBuffer);
+    glDeleteBuffers(1, &instanceBuffer);
 
     glDeleteProgram(shaderProgram);
 }
@@ -237,6 +190,33 @@ void Renderer::DrawSprite(const Sprite& sprite, float x, float y, float z, float
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
 }
 
+// Draw a sprite at many positions with one draw call;
+// Width and height default to 1.0.
+
+void Renderer::DrawSprites(const Sprite& sprite, const vector2f* pPositions, int count, float z, float w, float h) const
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, sprite.identifier);
+    glUniform3f(positionUniform, 0.0f, 0.0f, z);
+    glUniform3f(scaleUniform, w, h, 1.0f);
+    glUniform4f(coordsUniform, sprite.x, sprite.y, sprite.w, sprite.h);
+
+    // Upload the positions and draw an instance at each.
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vector2f) * count, pPositions, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(2);
+
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, count);
+
+    glDisableVertexAttribArray(2);
+    glVertexAttrib2f(2, 0.0f, 0.0f);
+}
+
 // Draw a string at a position with an alignment;
 // Alignment: 0.0 = left, 0.5 = centre, 1.0 = right.
 
@@ -293,17 +273,44 @@ void Renderer::Clear() const
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-// Get a sprite sheet from file path.
+// Get a sprite sheet from file path;
+// An image decoded in advance can be given to be used if the sheet is not loaded yet.
 
-SpriteSheet Renderer::GetSheet(std::string_view path)
+SpriteSheet Renderer::GetSheet(std::string_view path, const Image* pImage)
 {
-    // If the sprite sheet is already loaded, return it.
+    // If the sprite sheet is already loaded, return it;
+    // Paths are copied as keys since callers may pass temporary strings.
+
+    std::string key(path);
+    auto location = sheets.find(key);
+
+    if (location != sheets.end())
+    {
+        return location->second;
+    }
+
+    // Load an image into an OpenGL texture, unless it was already decoded.
+
+    Image image;
 
-    if (sheets.find(path) != sheets.end())
+    if (!pImage)
     {
-        return sheets.at(path);
+        LoadImageFile(path, image);
+        pImage = &image;
     }
 
+    // Cache and return the sprite sheet.
+
+    SpriteSheet sheet = CreateSheet(pImage->pixels.data(), pImage->width, pImage->height);
+    sheets[key] = sheet;
+
+    return sheet;
+}
+
+// Create a sprite sheet from RGBA pixels, stored from the bottom row up.
+
+SpriteSheet Renderer::CreateSheet(const unsigned char* pPixels, int width, int height)
+{
     // Setup an OpenGL texture.
 
     unsigned int texture;
@@ -315,17 +322,10 @@ SpriteSheet Renderer::GetSheet(std::string_view path)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    // Load an image into the OpenGL texture.
+    // Upload the pixels into the OpenGL texture.
 
-    int width, height;
-    std::vector<unsigned char> pixels = LoadImageFile(path, width, height);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
-
-    // Cache and return the sprite sheet.
-
-    SpriteSheet sheet = {texture, width, height};
-    sheets[path] = sheet;
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pPixels);
     textures.push_back(texture);
 
-    return sheet;
+    return {texture, width, height};
 }
\ No newline at end of file
@@ -1,9 +1,13 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include "image.h"
 #include "sprite_sheet.h"
+#include "core/maths/maths.h"
+#include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 extern class Renderer* pRenderer;
 
@@ -18,16 +22,19 @@ public:
     void SetProjection(float l, float r, float b, float t, float depth) const;
 
     void DrawSprite(const Sprite& sprite, float x, float y, float z, float w = 1.0f, float h = 1.0f) const;
+    void DrawSprites(const Sprite& sprite, const vector2f* pPositions, int count, float z, float w = 1.0f, float h = 1.0f) const;
     void DrawString(std::string_view string, float x, float y, float z, float alignment = 0.5f) const;
     void Clear() const;
 
-    SpriteSheet GetSheet(std::string_view path);
+    SpriteSheet GetSheet(std::string_view path, const Image* pImage = nullptr);
+    SpriteSheet CreateSheet(const unsigned char* pPixels, int width, int height);
 
 private:
     unsigned int shaderProgram;
     unsigned int vertexArray;
     unsigned int vertexBuffer;
     unsigned int indexBuffer;
+    unsigned int instanceBuffer;
 
     int projectionUniform;
     int positionUniform;
@@ -35,7 +42,7 @@ private:
     int coordsUniform;
 
     std::vector<unsigned int> textures;
-    std::unordered_map<std::string_view, SpriteSheet> sheets;
+    std::unordered_map<std::string, SpriteSheet> sheets;
 
     Sprite fontSprites[95];
 };
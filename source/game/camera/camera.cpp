@@ -7,7 +7,7 @@ Camera* pCamera;
 // Initialise the camera.
 
 Camera::Camera()
-    : shakeTime(0.0f), unitScale(64.0f), shakeAmount(1.0f)
+    : shakeTime(0.0f), interpolation(1.0f), unitScale(64.0f), shakeAmount(1.0f)
 {
     pCamera = this;
 }
@@ -16,6 +16,8 @@ Camera::Camera()
 
 void Camera::Update(float delta)
 {
+    previousPosition = position;
+
     bounds.x = (float) pWindow->GetWidth() / (unitScale * 2.0f);
     bounds.y = (float) pWindow->GetHeight() / (unitScale * 2.0f);
 
@@ -39,8 +41,10 @@ void Camera::Update(float delta)
 
 void Camera::ApplyWorldProjection() const
 {
-    float x = Snap(position.x + shake.x, 1.0f / unitScale);
-    float y = Snap(position.y + shake.y, 1.0f / unitScale);
+    vector2f renderPosition = Lerp(previousPosition, position, interpolation);
+
+    float x = Snap(renderPosition.x + shake.x, 1.0f / unitScale);
+    float y = Snap(renderPosition.y + shake.y, 1.0f / unitScale);
 
     pRenderer->SetProjection(x - bounds.x, x + bounds.x, y - bounds.y, y + bounds.y, 4.0f);
 }
@@ -52,11 +56,24 @@ void Camera::ApplyScreenProjection() const
     pRenderer->SetProjection(-bounds.x, bounds.x, -bounds.y, bounds.y, 4.0f);
 }
 
-// Set the camera's position.
+// Set the camera's position;
+// Unless interpolated, the camera snaps to the position.
 
-void Camera::SetPosition(vector2f position)
+void Camera::SetPosition(vector2f position, bool interpolate)
 {
     this->position = position;
+
+    if (!interpolate)
+    {
+        previousPosition = position;
+    }
+}
+
+// Set the fraction of a tick elapsed since the last update.
+
+void Camera::SetInterpolation(float alpha)
+{
+    interpolation = alpha;
 }
 
 // Set the camera's unit scale.
@@ -14,7 +14,8 @@ public:
     void ApplyWorldProjection() const;
     void ApplyScreenProjection() const;
 
-    void SetPosition(vector2f position);
+    void SetPosition(vector2f position, bool interpolate = false);
+    void SetInterpolation(float alpha);
     void SetUnitScale(int scale);
     void SetShakeStrength(float strength);
     void ApplyCameraShake(float strength);
@@ -24,9 +25,11 @@ public:
 
 private:
     vector2f position;
+    vector2f previousPosition;
     vector2f bounds;
     vector2f shake;
     float shakeTime;
+    float interpolation;
 
     float unitScale;
     float shakeAmount;
@@ -29,6 +29,15 @@ Configuration::Configuration(std::string_view path)
     fullscreen = config["graphics"]["fullscreen"].value_or(false);
 
     masterVolume = config["sound"]["master_volume"].value_or(0.25f);
+    sampleRate = config["sound"]["sample_rate"].value_or(0);
+    periodSize = config["sound"]["period_size"].value_or(0);
+    periodCount = config["sound"]["period_count"].value_or(0);
+    audioStats = config["sound"]["show_audio_stats"].value_or(false);
+
+    tickRate = config["simulation"]["tick_rate"].value_or(120);
+    chainDelay = config["simulation"]["chain_delay"].value_or(0.0f);
+
+    rewindMemory = config["practice"]["rewind_memory"].value_or(0);
 
     saveSlot = config["saves"]["save_slot"].value_or("saves/slot_1.save");
 
@@ -42,6 +51,17 @@ Configuration::Configuration(std::string_view path)
 
     masterVolume = Max(masterVolume, 0.0f);
 
+    // Zero leaves the audio device's setting alone.
+
+    sampleRate = sampleRate == 0 ? 0 : Clamp(sampleRate, 8000, 192000);
+    periodSize = periodSize == 0 ? 0 : Clamp(periodSize, 32, 8192);
+    periodCount = periodCount == 0 ? 0 : Clamp(periodCount, 2, 8);
+
+    tickRate = Clamp(tickRate, 20, 240);
+    chainDelay = Clamp(chainDelay, 0.0f, 1.0f);
+
+    rewindMemory = Clamp(rewindMemory, 0, 65536);
+
     if (result)
     {
         LOG("Loaded configuration from \"" << path << "\".");
@@ -80,6 +100,26 @@ Configuration::~Configuration()
 
     file << "# How loud all sounds are\n# (real number, at least 0)\n";
     file << "master_volume = " << masterVolume << std::endl;
+    file << "# Samples per second the sound is played at\n# (integer, from 8000 to 192000, 0 for the device's default)\n";
+    file << "sample_rate = " << sampleRate << std::endl;
+    file << "# Frames mixed at a time, lower for less delay before sounds are heard\n# (integer, from 32 to 8192, 0 for the device's default)\n";
+    file << "period_size = " << periodSize << std::endl;
+    file << "# Periods buffered by the device, lower for less delay but more risk of crackling\n# (integer, from 2 to 8, 0 for the device's default)\n";
+    file << "period_count = " << periodCount << std::endl;
+    file << "# Should show how hard the audio mixer is working?\n# (boolean, true or false)\n";
+    file << "show_audio_stats = " << (audioStats ? "true" : "false") << std::endl;
+
+    file << "\n[simulation]\n\n";
+
+    file << "# How many times the game updates per second\n# (integer, from 20 to 240)\n";
+    file << "tick_rate = " << tickRate << std::endl;
+    file << "# Seconds between each link of a dynamite chain reaction\n# (real number, from 0 to 1)\n";
+    file << "chain_delay = " << chainDelay << std::endl;
+
+    file << "\n[practice]\n\n";
+
+    file << "# Kibibytes of level history kept for rewinding with R\n# (integer, from 0 to 65536, 0 to disable)\n";
+    file << "rewind_memory = " << rewindMemory << std::endl;
 
     file << "\n[saves]\n\n";
 
@@ -23,6 +23,13 @@ public:
     int windowHeight;
     bool fullscreen;
     float masterVolume;
+    int sampleRate;
+    int periodSize;
+    int periodCount;
+    bool audioStats;
+    int tickRate;
+    float chainDelay;
+    int rewindMemory;
     std::string saveSlot;
 };
 
@@ -38,12 +38,31 @@ void Dynamite::Update(float delta)
     }
 }
 
+// Write the entity's changing state to a snapshot.
+
+void Dynamite::SaveState(SnapshotWriter& writer) const
+{
+    Entity::SaveState(writer);
+
+    writer.Write(fuseTime);
+}
+
+// Read the entity's changing state from a snapshot.
+
+void Dynamite::LoadState(SnapshotReader& reader)
+{
+    Entity::LoadState(reader);
+
+    fuseTime = reader.Read<float>();
+}
+
 // Render the entity.
 
-void Dynamite::Render() const
+void Dynamite::Render(float alpha) const
 {
     int index = (int) (fuseTime * 3.0f);
     const Sprite& sprite = dynamiteSprites[index];
+    vector2f renderPosition = GetRenderPosition(alpha);
 
-    pRenderer->DrawSprite(sprite, position.x - 0.1875f, position.y, 0.3f, 0.5f, 0.5f);
+    pRenderer->DrawSprite(sprite, renderPosition.x - 0.1875f, renderPosition.y, 0.3f, 0.5f, 0.5f);
 }
\ No newline at end of file
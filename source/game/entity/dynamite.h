@@ -9,7 +9,10 @@ public:
     Dynamite(vector2f position);
 
     void Update(float delta) override;
-    void Render() const override;
+    void Render(float alpha) const override;
+
+    void SaveState(SnapshotWriter& writer) const override;
+    void LoadState(SnapshotReader& reader) override;
 
 private:
     float fuseTime;
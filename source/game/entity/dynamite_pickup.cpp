@@ -13,7 +13,7 @@ DynamitePickup::DynamitePickup(vector2f position)
     SpriteSheet sheet = pRenderer->GetSheet("assets/sprites/entity/dynamite_pickup.bmp");
     pickupSprite = sheet.GetSprite(0, 0, 4, 6);
 
-    pickupSound = pSoundMixer->GetSound("assets/sounds/dynamite_pickup.wav");
+    pickupSound = pSoundMixer->GetSound("assets/sounds/dynamite_pickup.wav", defaultVoiceCount, 1, 0.05f);
 
     // Save the player to check distance in Update.
 
@@ -49,11 +49,30 @@ void DynamitePickup::Update(float delta)
     }
 }
 
+// Write the entity's changing state to a snapshot.
+
+void DynamitePickup::SaveState(SnapshotWriter& writer) const
+{
+    Entity::SaveState(writer);
+
+    writer.Write(bobbingTime);
+}
+
+// Read the entity's changing state from a snapshot.
+
+void DynamitePickup::LoadState(SnapshotReader& reader)
+{
+    Entity::LoadState(reader);
+
+    bobbingTime = reader.Read<float>();
+}
+
 // Render the entity.
 
-void DynamitePickup::Render() const
+void DynamitePickup::Render(float alpha) const
 {
     float height = (sin(bobbingTime * 4.0f) + 1.0f) * 0.125f;
+    vector2f renderPosition = GetRenderPosition(alpha);
 
-    pRenderer->DrawSprite(pickupSprite, position.x - 0.25f, position.y + height, 0.4f, 0.5f, 0.75f);
+    pRenderer->DrawSprite(pickupSprite, renderPosition.x - 0.25f, renderPosition.y + height, 0.4f, 0.5f, 0.75f);
 }
\ No newline at end of file
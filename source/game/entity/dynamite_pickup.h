@@ -11,7 +11,10 @@ public:
     DynamitePickup(vector2f position);
 
     void Update(float delta) override;
-    void Render() const override;
+    void Render(float alpha) const override;
+
+    void SaveState(SnapshotWriter& writer) const override;
+    void LoadState(SnapshotReader& reader) override;
 
 private:
     float bobbingTime;
@@ -1,100 +1,48 @@
 #include "entity.h"
-#include "game/level/level.h"
+#include "game/level/tile_collision.h"
 
 // Initialise the entity.
 
 Entity::Entity(vector2f position, vector2f bounds, float restitution)
-    : position(position), bounds(bounds), restitution(restitution)
+    : position(position), previousPosition(position), bounds(bounds), restitution(restitution)
 {}
 
 // Update the entity.
 
 void Entity::Update(float delta)
 {
+    previousPosition = position;
+
     if (!velocity.IsNearlyZero())
     {
-        float left = position.x - bounds.x * 0.5f;
-        float right = position.x + bounds.x * 0.5f;
-        float bottom = position.y - bounds.y * 0.5f;
-        float top = position.y + bounds.y * 0.5f;
-        float halfWidth = bounds.x * 0.5f + epsilon;
-        float halfHeight = bounds.y * 0.5f + epsilon;
-
-        // Prevent collisions when moving right.
-
-        if (velocity.x > 0)
-        {
-            float xMoved = right + velocity.x * delta;
-
-            if (pLevel->IsSolid((int) xMoved, (int) bottom) || pLevel->IsSolid((int) xMoved, (int) top))
-            {
-                position.x = ceil(position.x) - halfWidth;
-                velocity.x *= -restitution;
-            }
-            else
-            {
-                position.x += velocity.x * delta;
-            }
-        }
-
-        // Prevent collisions when moving left.
-
-        else if (velocity.x < 0)
-        {
-            float xMoved = left + velocity.x * delta;
-
-            if (pLevel->IsSolid((int) xMoved, (int) bottom) || pLevel->IsSolid((int) xMoved, (int) top))
-            {
-                position.x = floor(position.x) + halfWidth;
-                velocity.x *= -restitution;
-            }
-            else
-            {
-                position.x += velocity.x * delta;
-            }
-        }
-
-        // Prevent collisions when moving up.
-
-        if (velocity.y > 0)
-        {
-            float yMoved = top + velocity.y * delta;
-
-            if (pLevel->IsSolid((int) left, (int) yMoved) || pLevel->IsSolid((int) right, (int) yMoved))
-            {
-                position.y = ceil(position.y) - halfHeight;
-                velocity.y *= -restitution;
-            }
-            else
-            {
-                position.y += velocity.y * delta;
-            }
-        }
-
-        // Prevent collisions when moving down.
-
-        else if (velocity.y < 0)
-        {
-            float yMoved = bottom + velocity.y * delta;
-
-            if (pLevel->IsSolid((int) left, (int) yMoved) || pLevel->IsSolid((int) right, (int) yMoved))
-            {
-                position.y = floor(position.y) + halfHeight;
-                velocity.y *= -restitution;
-            }
-            else
-            {
-                position.y += velocity.y * delta;
-            }
-        }
+        MoveBox(position, velocity, bounds * 0.5f, restitution, delta);
     }
 }
 
+// Write the entity's changing state to a snapshot.
+
+void Entity::SaveState(SnapshotWriter& writer) const
+{
+    writer.Write(position);
+    writer.Write(previousPosition);
+    writer.Write(velocity);
+}
+
+// Read the entity's changing state from a snapshot.
+
+void Entity::LoadState(SnapshotReader& reader)
+{
+    position = reader.Read<vector2f>();
+    previousPosition = reader.Read<vector2f>();
+    velocity = reader.Read<vector2f>();
+}
+
 // Set the entity's position.
 
 void Entity::SetPosition(vector2f position)
 {
     this->position = position;
+    previousPosition = position;
 }
 
 // Set the entity's velocity.
@@ -111,6 +59,14 @@ vector2f Entity::GetPosition() const
     return position;
 }
 
+// Get the entity's position between the previous and current tick;
+// Alpha is the fraction of a tick elapsed since the last update.
+
+vector2f Entity::GetRenderPosition(float alpha) const
+{
+    return Lerp(previousPosition, position, alpha);
+}
+
 // Get the extent of the entity's bounds.
 
 vector2f Entity::GetBounds() const
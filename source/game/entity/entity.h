@@ -2,6 +2,7 @@
 #define ENTITY_H
 
 #include "core/minimal.h"
+#include "game/rewind/snapshot.h"
 
 class Entity
 {
@@ -10,17 +11,22 @@ public:
     virtual ~Entity() = default;
 
     virtual void Update(float delta);
-    virtual void Render() const = 0;
+    virtual void Render(float alpha) const = 0;
+
+    virtual void SaveState(SnapshotWriter& writer) const;
+    virtual void LoadState(SnapshotReader& reader);
 
     void SetPosition(vector2f position);
     void SetVelocity(vector2f velocity);
 
     vector2f GetPosition() const;
+    vector2f GetRenderPosition(float alpha) const;
     vector2f GetBounds() const;
     vector2f GetVelocity() const;
 
 protected:
     vector2f position;
+    vector2f previousPosition;
     vector2f bounds;
     vector2f velocity;
     float restitution;
@@ -30,14 +30,16 @@ Player::Player(vector2f position)
         hudSprites[i] = uiSheet.GetSprite(i * 8, 48, 8, 8);
     }
 
-    stepSounds[0] = pSoundMixer->GetSound("assets/sounds/player_step_a.wav");
-    stepSounds[1] = pSoundMixer->GetSound("assets/sounds/player_step_b.wav");
-    stepSounds[2] = pSoundMixer->GetSound("assets/sounds/player_step_c.wav");
-    stepSounds[3] = pSoundMixer->GetSound("assets/sounds/player_step_d.wav");
-    stepSounds[4] = pSoundMixer->GetSound("assets/sounds/player_step_e.wav");
-
-    hurtSound = pSoundMixer->GetSound("assets/sounds/player_hurt.wav");
-    throwSound = pSoundMixer->GetSound("assets/sounds/dynamite_throw.wav");
+    // Footsteps are frequent and the first to be cut off when too many sounds play.
+
+    stepSounds[0] = pSoundMixer->GetSound("assets/sounds/player_step_a.wav", 2, 0);
+    stepSounds[1] = pSoundMixer->GetSound("assets/sounds/player_step_b.wav", 2, 0);
+    stepSounds[2] = pSoundMixer->GetSound("assets/sounds/player_step_c.wav", 2, 0);
+    stepSounds[3] = pSoundMixer->GetSound("assets/sounds/player_step_d.wav", 2, 0);
+    stepSounds[4] = pSoundMixer->GetSound("assets/sounds/player_step_e.wav", 2, 0);
+
+    hurtSound = pSoundMixer->GetSound("assets/sounds/player_hurt.wav", 2, 2, 0.1f);
+    throwSound = pSoundMixer->GetSound("assets/sounds/dynamite_throw.wav", defaultVoiceCount, 1);
 }
 
 // Update the entity.
@@ -48,7 +50,7 @@ void Player::Update(float delta)
 
     // Make the camera follow the player.
 
-    pCamera->SetPosition(Lerp(pCamera->GetPosition(), GetPosition(), delta * 4.0f));
+    pCamera->SetPosition(Lerp(pCamera->GetPosition(), GetPosition(), delta * 4.0f), true);
 
     // Pause the game with Escape.
 
@@ -61,7 +63,9 @@ void Player::Update(float delta)
 
     if (pController->WasPressed(KEY_F5))
     {
-        Level::Load(pLevel->GetName());
+        pLevel->Retry();
+
+        return;
     }
 
     if (IsAlive())
@@ -126,9 +130,35 @@ void Player::Update(float delta)
     }
 }
 
+// Write the entity's changing state to a snapshot.
+
+void Player::SaveState(SnapshotWriter& writer) const
+{
+    Entity::SaveState(writer);
+
+    writer.Write(health);
+    writer.Write(dynamite);
+    writer.Write(invincibleTime);
+    writer.Write(animationTime);
+    writer.Write(stepCount);
+}
+
+// Read the entity's changing state from a snapshot.
+
+void Player::LoadState(SnapshotReader& reader)
+{
+    Entity::LoadState(reader);
+
+    health = reader.Read<int>();
+    dynamite = reader.Read<int>();
+    invincibleTime = reader.Read<float>();
+    animationTime = reader.Read<float>();
+    stepCount = reader.Read<int>();
+}
+
 // Render the entity.
 
-void Player::Render() const
+void Player::Render(float alpha) const
 {
     int index = IsAlive() ? 16 : 17;
 
@@ -137,11 +167,13 @@ void Player::Render() const
 
     if (IsAlive() && velocity.SqrLength() > 0.01f)
     {
-        int direction = (int) ((velocity.Rotation() + 22.5f) / 45.0f) % 8;
+        int direction = velocity.Octant();
         index = (int) (animationTime * 6.0f) * 8 + direction;
     }
 
-    pRenderer->DrawSprite(playerSprites[index], position.x - 0.3125f, position.y, 0.5f, 0.625f, 0.875f);
+    vector2f renderPosition = GetRenderPosition(alpha);
+
+    pRenderer->DrawSprite(playerSprites[index], renderPosition.x - 0.3125f, renderPosition.y, 0.5f, 0.625f, 0.875f);
 
     // Render the heads-up display.
 
@@ -9,7 +9,10 @@ public:
     Player(vector2f position);
 
     void Update(float delta) override;
-    void Render() const override;
+    void Render(float alpha) const override;
+
+    void SaveState(SnapshotWriter& writer) const override;
+    void LoadState(SnapshotReader& reader) override;
 
     void Damage(int amount);
     bool GiveDynamite();
@@ -1,210 +1,293 @@
 #include "level.h"
+#include "level_file.h"
 #include "level_list.h"
 #include "core/audio/sound_mixer.h"
+#include "core/input/controller.h"
 #include "core/video/renderer.h"
 #include "game/camera/camera.h"
 #include "game/entity/player.h"
+#include "game/entity/dynamite.h"
 #include "game/entity/dynamite_pickup.h"
-#include "game/entity/splinter.h"
 #include "game/menu/level_complete_menu.h"
+#include "game/replay/replay_recorder.h"
 #include "game/save/save_slot.h"
-#include <fstream>
+#include <algorithm>
 
 std::shared_ptr<Level> pLevel;
 
-// Load level data from a file.
+float Level::chainDelay = 0.0f;
+size_t Level::rewindMemory = 0;
 
-static std::vector<Tile> LoadLevelFile(std::string_view path, std::string& outBiome, int& outWidth, int& outHeight, vector2f& outStart, vector2f& outFinish, std::vector<vector2f>& outDynamites)
+// Ticks between each full snapshot kept for rewinding.
+
+constexpr int rewindKeyframeInterval = 60;
+
+// Kinds of entity stored in snapshots.
+
+enum EntityKind : unsigned char
 {
-    std::ifstream file(path.data(), std::ios::binary);
-    std::vector<Tile> tiles;
+    PLAYER_ENTITY,
+    DYNAMITE_ENTITY,
+    PICKUP_ENTITY
+};
 
-    // Validate that the file was opened.
+// Get the kind an entity is stored as in snapshots.
 
-    if (!file.is_open())
+static EntityKind GetEntityKind(const Entity* pEntity)
+{
+    if (dynamic_cast<const Player*>(pEntity))
     {
-        ERR("Failed to load level from \"" << path << "\".");
+        return PLAYER_ENTITY;
+    }
 
-        return std::move(tiles);
+    if (dynamic_cast<const Dynamite*>(pEntity))
+    {
+        return DYNAMITE_ENTITY;
     }
 
-    // Read the environment of the level.
+    return PICKUP_ENTITY;
+}
 
-    int biomeLength;
-    file.read((char*) &biomeLength, 4);
+// Create an entity of a kind, to have its state read from a snapshot.
 
-    char* biome = new char[biomeLength + 1];
-    biome[biomeLength] = '\0';
+static std::unique_ptr<Entity> CreateEntity(EntityKind kind)
+{
+    switch (kind)
+    {
+        case PLAYER_ENTITY:   return std::make_unique<Player>(vector2f::zero);
+        case DYNAMITE_ENTITY: return std::make_unique<Dynamite>(vector2f::zero);
+        default:              return std::make_unique<DynamitePickup>(vector2f::zero);
+    }
+}
 
-    file.read(biome, biomeLength);
+// Initialise the level.
 
-    outBiome = biome;
-    delete[] biome;
+Level::Level(std::shared_ptr<const LevelTemplate> pTemplate)
+    : name(pTemplate->name), pTemplate(std::move(pTemplate)), retrying(false), tileTypes(), playTime(0.0),
+      levelWidth(0), levelHeight(0), outOfBoundsCount(0), chainTime(0.0f), splinters(0.375f, 1.0f, 4.0f),
+      rewound(false), explodeSound(), completeSound()
+{
+    pLevel.reset(this);
 
-    // Read the dimensions of the level.
+    // Register the tile types.
 
-    file.read((char*) &outWidth, 4);
-    file.read((char*) &outHeight, 4);
+    using namespace std::placeholders;
 
-    // Read the start and finish positions.
+    tileTypes[0] = {false, false, 0,  nullptr};                                          // Ground tile.
+    tileTypes[1] = {true,  true,  5,  nullptr};                                          // Stone tile.
+    tileTypes[2] = {true,  true,  6,  std::bind(&Level::OnWoodBreak, this, _1, _2)};     // Wood tile.
+    tileTypes[3] = {true,  true,  7,  std::bind(&Level::OnDynamiteBreak, this, _1, _2)}; // Dynamite tile.
+    tileTypes[4] = {true,  false, 10, nullptr};                                          // Wall tile.
 
-    int xStart, yStart;
-    file.read((char*) &xStart, 4);
-    file.read((char*) &yStart, 4);
+    // Take the level's layout from its template.
 
-    int xFinish, yFinish;
-    file.read((char*) &xFinish, 4);
-    file.read((char*) &yFinish, 4);
+    const LevelFile& file = this->pTemplate->file;
 
-    outStart = vector2f((float) xStart + 0.5f, (float) yStart + 0.5f);
-    outFinish = vector2f((float) xFinish + 0.5f, (float) yFinish + 0.5f);
+    levelWidth = file.width;
+    levelHeight = file.height;
+    start = file.start;
+    finish = file.finish;
 
-    // Read all dynamite pick-up positions.
+    // Load the necessary resources.
 
-    int dynamiteCount;
-    file.read((char*) &dynamiteCount, 4);
+    SpriteSheet splinterSheet = pRenderer->GetSheet("assets/sprites/entity/splinter.bmp");
+    splinters.SetSprite(splinterSheet.GetSprite(0, 0, 3, 3), 0.2f);
 
-    outDynamites.reserve(dynamiteCount);
+    explodeSound = pSoundMixer->GetSound("assets/sounds/explosion.wav", 8, 2, 0.05f);
+    completeSound = pSoundMixer->GetSound("assets/sounds/level_complete.wav", 1, 3);
 
-    for (int i = 0; i < dynamiteCount; i++)
-    {
-        int xDynamite, yDynamite;
-        file.read((char*) &xDynamite, 4);
-        file.read((char*) &yDynamite, 4);
+    pSoundMixer->PlayMusic("assets/music/" + file.biome + ".wav");
 
-        outDynamites.emplace_back((float) xDynamite + 0.5f, (float) yDynamite + 0.5f);
+    if (rewindMemory > 0)
+    {
+        pRewind = std::make_unique<RewindBuffer>(rewindMemory, rewindKeyframeInterval);
     }
 
-    // Read the level's tile data.
+    Reset();
 
-    tiles.reserve(outWidth * outHeight);
+    // Read the next level in the background while this one is played.
 
-    for (int i = 0; i < outWidth * outHeight; i++)
-    {
-        char tile;
-        file.read((char*) &tile, 1);
+    auto location = std::find(std::begin(levelList), std::end(levelList), this->name);
 
-        tiles.push_back({(int) tile, 0});
+    if (location != std::end(levelList) && location + 1 != std::end(levelList))
+    {
+        LevelTemplate::Prefetch(*(location + 1));
     }
 
-    // Set the tile's variants.
+    LOG("Instantiated the Level (" << this->name << ").");
+}
+
+// Terminate the level.
 
-    for (int i = 0; i < outWidth * outHeight; i++)
-    {
-        Tile& tile = tiles[i];
-        int x = i % outWidth;
-        int y = i / outWidth;
+Level::~Level()
+{
+    entities.clear();
 
-        // Ground varies based on the tile above it.
+    LOG("Destroyed the Level.");
+}
 
-        if (tile.type == 0)
-        {
-            tile.variant = tiles[i + outWidth].type;
-        }
+// Reset the level to its initial state from its template;
+// Copies the pristine tiles and respawns the entities without any I/O.
 
-        // Walls vary based on their neighbours.
+void Level::Reset()
+{
+    entities.clear();
+    explosionQueue.clear();
+    splinters.Clear();
 
-        else if (tile.type == 4)
-        {
-            bool offBottom = (y > 0);
-            bool offTop = (y < outHeight - 1);
-            bool offLeft = (x > 0);
-            bool offRight = (x < outWidth - 1);
-
-            bool bottom = offBottom && tiles[i - outWidth].type != 4;
-            bool top = offTop && tiles[i + outWidth].type != 4;
-            bool left = offLeft && tiles[i - 1].type != 4;
-            bool right = offRight && tiles[i + 1].type != 4;
-
-            bool bottomLeft = offBottom && offLeft && tiles[i - outWidth - 1].type != 4;
-            bool bottomRight = offBottom && offRight && tiles[i - outWidth + 1].type != 4;
-            bool topLeft = offTop && offLeft && tiles[i + outWidth - 1].type != 4;
-            bool topRight = offTop && offRight && tiles[i + outWidth + 1].type != 4;
-
-            tile.variant = bottom << 7 | top << 6 | left << 5 | right << 4 | bottomLeft << 3 | bottomRight << 2 | topLeft << 1 | topRight;
-        }
+    tiles = pTemplate->file.tiles;
+    playTime = 0.0;
+    chainTime = 0.0f;
+    outOfBoundsCount = 0;
+    retrying = false;
+    rewound = false;
+
+    if (pRewind)
+    {
+        pRewind->Clear();
     }
 
-    LOG("Loaded level from \"" << path << "\".");
+    // Spawn the initial entities.
 
-    return std::move(tiles);
-}
+    Instantiate<Player>(start);
 
-// Initialise the level.
+    for (const vector2f& position : pTemplate->file.dynamites)
+    {
+        Instantiate<DynamitePickup>(position);
+    }
 
-Level::Level(std::string name)
-    : name(std::move(name)), tileTypes(), playTime(0.0), levelWidth(0),
-      levelHeight(0), sprites(), explodeSound(), completeSound()
-{
-    pLevel.reset(this);
+    pCamera->SetPosition(start);
 
-    // Register the tile types.
+    // Begin recording the run's input.
 
-    using namespace std::placeholders;
+    if (pRecorder)
+    {
+        pRecorder->Begin(name, pTemplate->hash);
+    }
+}
 
-    tileTypes[0] = {false, false, 0,  nullptr};                                          // Ground tile.
-    tileTypes[1] = {true,  true,  5,  nullptr};                                          // Stone tile.
-    tileTypes[2] = {true,  true,  6,  std::bind(&Level::OnWoodBreak, this, _1, _2)};     // Wood tile.
-    tileTypes[3] = {true,  true,  7,  std::bind(&Level::OnDynamiteBreak, this, _1, _2)}; // Dynamite tile.
-    tileTypes[4] = {true,  false, 10, nullptr};                                          // Wall tile.
+// Retry the level once the current update is finished;
+// Entities may request this while they are being updated.
 
-    // Load the level from a file.
+void Level::Retry()
+{
+    retrying = true;
+}
 
-    std::string path = "levels/" + this->name + ".level";
-    std::string biome;
-    std::vector<vector2f> dynamitePositions;
+// Write the level's changing state to a snapshot;
+// Covers the tiles, entities, particles, play time and queued explosions.
 
-    tiles = LoadLevelFile(path, biome, levelWidth, levelHeight, start, finish, dynamitePositions);
+void Level::SaveState(std::vector<unsigned char>& outState) const
+{
+    outState.clear();
+    SnapshotWriter writer(outState);
 
-    // Load the necessary resources.
+    writer.Write(playTime);
+    writer.Write(chainTime);
+    writer.Write((int) explosionQueue.size());
+    writer.Write(explosionQueue.data(), sizeof(vector2f) * explosionQueue.size());
 
-    SpriteSheet levelSheet = pRenderer->GetSheet("assets/sprites/level/" + biome + ".bmp");
-    SpriteSheet wallSheet = pRenderer->GetSheet("assets/sprites/level/walls.bmp");
+    // Tiles are written as a type and variant byte each.
 
-    for (int i = 0; i < 10; i++)
+    for (const Tile& tile : tiles)
     {
-        int x = (i % 4) * 8;
-        int y = (i / 4) * 8;
-
-        sprites[i] = levelSheet.GetSprite(x, y, 8, 8);
+        unsigned char bytes[2] = {(unsigned char) tile.type, (unsigned char) tile.variant};
+        writer.Write(bytes);
     }
 
-    for (int i = 0; i < 256; i++)
-    {
-        int x = (i % 16) * 8;
-        int y = (i / 16) * 8;
+    // Entities are written in order, each after its kind.
+
+    writer.Write((int) entities.size());
 
-        sprites[i + 10] = wallSheet.GetSprite(x, y, 8, 8);
+    for (const std::unique_ptr<Entity>& pEntity : entities)
+    {
+        writer.Write(GetEntityKind(pEntity.get()));
+        pEntity->SaveState(writer);
     }
 
-    explodeSound = pSoundMixer->GetSound("assets/sounds/explosion.wav");
-    completeSound = pSoundMixer->GetSound("assets/sounds/level_complete.wav");
+    splinters.SaveState(writer);
+}
 
-    // Spawn the initial entities.
+// Restore the level's changing state from a snapshot;
+// Entities are reused where the kinds match in order, so only the difference is created or destroyed;
+// The player always comes first, so it is kept and the pickups that look it up still point at it.
 
-    Instantiate<Player>(start);
+bool Level::LoadState(const std::vector<unsigned char>& state)
+{
+    SnapshotReader reader(state);
 
-    for (const vector2f& position : dynamitePositions)
+    playTime = reader.Read<double>();
+    chainTime = reader.Read<float>();
+    explosionQueue.resize(Max(reader.Read<int>(), 0));
+    reader.Read(explosionQueue.data(), sizeof(vector2f) * explosionQueue.size());
+
+    for (Tile& tile : tiles)
     {
-        Instantiate<DynamitePickup>(position);
+        tile.type = reader.Read<unsigned char>();
+        tile.variant = reader.Read<unsigned char>();
     }
 
-    LOG("Instantiated the Level (" << this->name << ").");
-}
+    int entityCount = reader.Read<int>();
+    int restoredCount = 0;
 
-// Terminate the level.
+    for (; restoredCount < entityCount && reader.IsValid(); restoredCount++)
+    {
+        EntityKind kind = reader.Read<EntityKind>();
 
-Level::~Level()
-{
-    entities.clear();
+        if (restoredCount == (int) entities.size())
+        {
+            entities.push_back(CreateEntity(kind));
+        }
+        else if (GetEntityKind(entities[restoredCount].get()) != kind)
+        {
+            entities[restoredCount] = CreateEntity(kind);
+        }
 
-    LOG("Destroyed the Level.");
+        entities[restoredCount]->LoadState(reader);
+    }
+
+    entities.erase(entities.begin() + Min(restoredCount, (int) entities.size()), entities.end());
+
+    splinters.LoadState(reader);
+
+    return reader.IsValid();
 }
 
 // Update the level and its entities.
 
 void Level::Update(float delta)
 {
+    // Step back a tick while rewinding is held;
+    // Otherwise keep the state from before this tick to rewind to.
+
+    if (pRewind)
+    {
+        if (pController->IsHeldDown(KEY_R))
+        {
+            if (pRewind->Pop(rewindState) && LoadState(rewindState))
+            {
+                rewound = true;
+
+                Player* pPlayer = GetEntity<Player>();
+
+                if (pPlayer)
+                {
+                    pCamera->SetPosition(pPlayer->GetPosition(), true);
+                }
+            }
+
+            return;
+        }
+
+        SaveState(rewindState);
+        pRewind->Push(rewindState);
+    }
+
+    if (pRecorder)
+    {
+        pRecorder->Record(*pController);
+    }
+
     playTime += (double) delta;
 
     // Update all entities in the level.
@@ -217,13 +300,55 @@ void Level::Update(float delta)
             return;
         }
 
+        // Start over if the level is being retried.
+        if (retrying)
+        {
+            Reset();
+
+            return;
+        }
+
         entities[i]->Update(delta);
     }
+
+    if (retrying)
+    {
+        Reset();
+
+        return;
+    }
+
+    // Update the splinters and damage the player when fast ones are close.
+
+    splinters.Update(delta);
+
+    Player* pPlayer = GetEntity<Player>();
+
+    if (pPlayer && splinters.IsHitting(pPlayer->GetPosition(), 0.5f, 4.0f))
+    {
+        pPlayer->Damage(1);
+    }
+
+    // Spread delayed chain reactions over successive ticks.
+
+    if (!explosionQueue.empty())
+    {
+        chainTime += delta;
+
+        if (chainTime >= chainDelay)
+        {
+            std::vector<vector2f> wave;
+            wave.swap(explosionQueue);
+
+            chainTime = 0.0f;
+            ExplodeWave(wave);
+        }
+    }
 }
 
 // Render the level and its entities.
 
-void Level::Render() const
+void Level::Render(float alpha) const
 {
     pCamera->ApplyWorldProjection();
 
@@ -236,18 +361,20 @@ void Level::Render() const
         float x = (float) (i % levelWidth);
         float y = (float) (i / levelWidth) + 0.75f;
 
-        pRenderer->DrawSprite(sprites[type.spriteOffset + tile.variant], x, y, type.solid ? 1.0f : 0.0f);
+        pRenderer->DrawSprite(pTemplate->sprites[type.spriteOffset + tile.variant], x, y, type.solid ? 1.0f : 0.0f);
     }
 
-    pRenderer->DrawSprite(sprites[8], finish.x - 0.5f, finish.y - 0.5f, 0.1f);
-    pRenderer->DrawSprite(sprites[9], finish.x - 0.5f, finish.y + 0.5f, 1.1f);
+    pRenderer->DrawSprite(pTemplate->sprites[8], finish.x - 0.5f, finish.y - 0.5f, 0.1f);
+    pRenderer->DrawSprite(pTemplate->sprites[9], finish.x - 0.5f, finish.y + 0.5f, 1.1f);
 
     // Draw all entities in the level.
 
     for (int i = 0; i < entities.size(); i++)
     {
-        entities[i]->Render();
+        entities[i]->Render(alpha);
     }
+
+    splinters.Render(alpha);
 }
 
 // Destroy an entity.
@@ -265,13 +392,45 @@ void Level::Destroy(Entity* pEntity)
     }
 }
 
-// Create an explosion at a position.
+// Create an explosion at a position;
+// Chain reactions are resolved immediately unless a chain delay is set.
 
 void Level::Explode(vector2f position)
 {
+    ExplodeWave({position});
+
+    if (chainDelay <= 0.0f)
+    {
+        while (!explosionQueue.empty())
+        {
+            std::vector<vector2f> wave;
+            wave.swap(explosionQueue);
+
+            ExplodeWave(wave);
+        }
+    }
+}
+
+// Explode a wave of explosions at once;
+// Dynamite tiles broken by the wave are queued for the next wave.
+
+void Level::ExplodeWave(const std::vector<vector2f>& wave)
+{
+    // Shake and play a sound once per wave.
+
     pCamera->ApplyCameraShake(1.0f);
     pSoundMixer->PlaySound(explodeSound);
 
+    for (const vector2f& position : wave)
+    {
+        ExplodeAt(position);
+    }
+}
+
+// Apply a single explosion at a position.
+
+void Level::ExplodeAt(vector2f position)
+{
     // Push away all nearby entities.
 
     for (int i = 0; i < entities.size(); i++)
@@ -294,6 +453,8 @@ void Level::Explode(vector2f position)
         }
     }
 
+    splinters.Push(position, 4.0f, 4.0f);
+
     // Break all tiles in a 3 by 3 area.
 
     int x = (int) position.x;
@@ -315,13 +476,20 @@ void Level::Explode(vector2f position)
 
 void Level::Break(int x, int y)
 {
+    if (!IsInside(x, y))
+    {
+        outOfBoundsCount++;
+
+        return;
+    }
+
     int index = y * levelWidth + x;
     Tile& tile = tiles[index];
 
     if (tileTypes[tile.type].breakable)
     {
         auto onBreak = tileTypes[tile.type].pOnBreak;
-        tile = {0, tiles[index + levelWidth].type};
+        tile = {0, IsInside(x, y + 1) ? tiles[index + levelWidth].type : 0};
 
         // Call the break callback if one exists.
 
@@ -332,7 +500,7 @@ void Level::Break(int x, int y)
 
         // Update the variant of the tile below.
 
-        if (tiles[index - levelWidth].type == 0)
+        if (IsInside(x, y - 1) && tiles[index - levelWidth].type == 0)
         {
             tiles[index - levelWidth].variant = 0;
         }
@@ -344,7 +512,19 @@ void Level::Break(int x, int y)
 void Level::Complete()
 {
     pSoundMixer->PlaySound(completeSound);
-    pSave->CompleteLevel(name, playTime);
+
+    // Save the run's replay if it sets a new record;
+    // Rewound practice runs are neither recorded nor timed.
+
+    if (pSave && !rewound)
+    {
+        if (pRecorder && (!pSave->IsLevelCompleted(name) || playTime < pSave->GetLevelTime(name)))
+        {
+            pRecorder->Finish(playTime);
+        }
+
+        pSave->CompleteLevel(name, playTime);
+    }
 
     // Unlock the next level if this is a base game level.
 
@@ -357,7 +537,7 @@ void Level::Complete()
 
         // Only unlock the next level if one exists.
 
-        if (i < levelCount - 1)
+        if (i < levelCount - 1 && pSave)
         {
             pSave->UnlockLevel(levelList[i + 1]);
         }
@@ -394,10 +574,67 @@ double Level::GetTime() const
     return playTime;
 }
 
-// Check if a tile is solid.
+// Get the level's width in tiles.
+
+int Level::GetWidth() const
+{
+    return levelWidth;
+}
+
+// Get the level's height in tiles.
+
+int Level::GetHeight() const
+{
+    return levelHeight;
+}
+
+// Get the number of entities in the level.
+
+int Level::GetEntityCount() const
+{
+    return (int) entities.size();
+}
+
+// Get the number of particles in the level.
+
+int Level::GetParticleCount() const
+{
+    return splinters.GetCount();
+}
+
+// Get the number of tile accesses outside the level.
+
+int Level::GetOutOfBoundsCount() const
+{
+    return outOfBoundsCount;
+}
+
+// Get the level's rewind history, if rewinding is enabled.
+
+const RewindBuffer* Level::GetRewindBuffer() const
+{
+    return pRewind.get();
+}
+
+// Check if a tile position is inside the level.
+
+bool Level::IsInside(int x, int y) const
+{
+    return x >= 0 && y >= 0 && x < levelWidth && y < levelHeight;
+}
+
+// Check if a tile is solid;
+// Positions outside the level are treated as solid.
 
 bool Level::IsSolid(int x, int y) const
 {
+    if (!IsInside(x, y))
+    {
+        outOfBoundsCount++;
+
+        return true;
+    }
+
     return tileTypes[tiles[y * levelWidth + x].type].solid;
 }
 
@@ -413,27 +650,61 @@ void Level::OnWoodBreak(int x, int y)
     {
         float angle = (float) i * 45.0f + 22.5f;
 
-        Splinter* pSplinter = Instantiate<Splinter>(position);
-        pSplinter->SetVelocity(vector2f(32.0f, 0.0f).Rotated(angle));
+        splinters.Emit(position, vector2f(32.0f, 0.0f).Rotated(angle));
     }
 }
 
-// Dynamite tile break callback.
+// Dynamite tile break callback;
+// Queues an explosion for the next wave, once per tile since the tile is already broken.
 
 void Level::OnDynamiteBreak(int x, int y)
 {
-    vector2f position((float) x + 0.5f, (float) y + 0.5f);
+    explosionQueue.push_back(vector2f((float) x + 0.5f, (float) y + 0.5f));
+}
+
+// Load a level from a name;
+// Loading the current level again resets it in place;
+// Returns false if the level cannot be loaded, leaving any current level as it was.
+
+bool Level::Load(std::string_view name)
+{
+    if (pLevel && pLevel->name == name)
+    {
+        pLevel->Reset();
 
-    Explode(position);
+        return true;
+    }
+
+    START_METRIC("level_load");
+
+    std::shared_ptr<const LevelTemplate> pTemplate = LevelTemplate::Get(name);
+
+    if (!pTemplate)
+    {
+        ERR("Failed to load level \"" << name << "\".");
+
+        return false;
+    }
+
+    new Level(std::move(pTemplate));
+
+    STOP_METRIC("level_load");
+
+    return true;
 }
 
-// Load a level from a name.
+// Set the delay between the waves of chain reactions.
 
-void Level::Load(std::string_view name)
+void Level::SetChainDelay(float delay)
 {
-    new Level(std::string(name));
+    chainDelay = Max(delay, 0.0f);
+}
+
+// Set how much history is kept for rewinding, 0 to disable it.
 
-    pCamera->SetPosition(pLevel->GetStart());
+void Level::SetRewindMemory(int kibibytes)
+{
+    rewindMemory = (size_t) Max(kibibytes, 0) * 1024;
 }
 
 // Unload the current level.
@@ -1,9 +1,14 @@
 #ifndef LEVEL_H
 #define LEVEL_H
 
+#include "level_file.h"
+#include "level_template.h"
 #include "core/minimal.h"
+#include "game/particle/particle_system.h"
+#include "game/rewind/rewind_buffer.h"
 #include <functional>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -19,22 +24,21 @@ struct TileType
     std::function<void(int, int)> pOnBreak;
 };
 
-struct Tile
-{
-    int type;
-    int variant;
-};
-
 extern std::shared_ptr<class Level> pLevel;
 
 class Level
 {
 public:
-    Level(std::string name);
+    Level(std::shared_ptr<const LevelTemplate> pTemplate);
     ~Level();
 
     void Update(float delta);
-    void Render() const;
+    void Render(float alpha) const;
+    void Reset();
+    void Retry();
+
+    void SaveState(std::vector<unsigned char>& outState) const;
+    bool LoadState(const std::vector<unsigned char>& state);
 
     template<class T>
     T* Instantiate(vector2f position);
@@ -49,20 +53,33 @@ public:
     vector2f GetStart() const;
     vector2f GetFinish() const;
     double GetTime() const;
+    int GetWidth() const;
+    int GetHeight() const;
+    int GetEntityCount() const;
+    int GetParticleCount() const;
+    int GetOutOfBoundsCount() const;
+    const RewindBuffer* GetRewindBuffer() const;
+    bool IsInside(int x, int y) const;
     bool IsSolid(int x, int y) const;
 
 private:
+    void ExplodeWave(const std::vector<vector2f>& wave);
+    void ExplodeAt(vector2f position);
     void OnWoodBreak(int x, int y);
     void OnDynamiteBreak(int x, int y);
 
 public:
-    static void Load(std::string_view name);
+    static bool Load(std::string_view name);
     static void Unload();
+    static void SetChainDelay(float delay);
+    static void SetRewindMemory(int kibibytes);
     static std::string TimeToString(double time);
     static std::string FormatName(std::string name);
 
 private:
     std::string name;
+    std::shared_ptr<const LevelTemplate> pTemplate;
+    bool retrying;
 
     std::vector<std::unique_ptr<Entity>> entities;
     std::vector<Tile> tiles;
@@ -73,10 +90,23 @@ private:
     int levelHeight;
     vector2f start;
     vector2f finish;
+    mutable int outOfBoundsCount;
+
+    std::vector<vector2f> explosionQueue;
+    float chainTime;
+
+    ParticleSystem splinters;
+
+    std::unique_ptr<RewindBuffer> pRewind;
+    std::vector<unsigned char> rewindState;
+    bool rewound;
 
-    Sprite sprites[266];
     Sound explodeSound;
     Sound completeSound;
+
+private:
+    static float chainDelay;
+    static size_t rewindMemory;
 };
 
 // Instantiate an entity.
@@ -0,0 +1,446 @@
+#include "level_file.h"
+#include "core/file/asset_pack.h"
+#include "core/hash.h"
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+// Magic number at the start of version 2 level files.
+
+constexpr char levelMagic[4] = {'M', 'O', 'D', 'L'};
+
+// Level format flags;
+// Compressed levels store their tiles as runs of identical tiles.
+
+constexpr unsigned int compressedFlag = 1 << 0;
+
+// Limits checked when loading a level.
+
+constexpr int maxLevelSize = 256;
+constexpr int tileTypeCount = 5;
+
+// Fixed-size header of version 2 level files;
+// Followed by the dynamite positions (two ints each), then the tiles.
+
+struct LevelHeader
+{
+    char magic[4];
+    int version;
+    unsigned int flags;
+    unsigned int fileSize;
+    unsigned long long checksum; // Hash of every byte after this field.
+    char biome[32];
+    int width;
+    int height;
+    int start[2];
+    int finish[2];
+    int dynamiteCount;
+    unsigned int tileBytes;
+};
+
+static_assert(sizeof(LevelHeader) == 88, "Level header must have no padding.");
+
+constexpr size_t checksumEnd = offsetof(LevelHeader, checksum) + sizeof(unsigned long long);
+
+// Bounds-checked reading from a block of bytes.
+
+struct ByteReader
+{
+    const unsigned char* pData;
+    size_t size;
+    size_t offset;
+
+    bool Read(void* pOut, size_t count)
+    {
+        if (count > size - offset)
+        {
+            offset = size;
+
+            return false;
+        }
+
+        memcpy(pOut, pData + offset, count);
+        offset += count;
+
+        return true;
+    }
+};
+
+// Check if a tile position is inside a level's dimensions.
+
+static bool IsInside(int x, int y, int width, int height)
+{
+    return x >= 0 && y >= 0 && x < width && y < height;
+}
+
+// Set the variants of a level's tiles from their neighbours.
+
+static void BakeVariants(LevelFile& level)
+{
+    std::vector<Tile>& tiles = level.tiles;
+    int width = level.width;
+    int height = level.height;
+
+    for (int i = 0; i < width * height; i++)
+    {
+        Tile& tile = tiles[i];
+        int x = i % width;
+        int y = i / width;
+
+        // Ground varies based on the tile above it.
+
+        if (tile.type == 0)
+        {
+            tile.variant = (y < height - 1) ? tiles[i + width].type : 0;
+        }
+
+        // Walls vary based on their neighbours.
+
+        else if (tile.type == 4)
+        {
+            bool offBottom = (y > 0);
+            bool offTop = (y < height - 1);
+            bool offLeft = (x > 0);
+            bool offRight = (x < width - 1);
+
+            bool bottom = offBottom && tiles[i - width].type != 4;
+            bool top = offTop && tiles[i + width].type != 4;
+            bool left = offLeft && tiles[i - 1].type != 4;
+            bool right = offRight && tiles[i + 1].type != 4;
+
+            bool bottomLeft = offBottom && offLeft && tiles[i - width - 1].type != 4;
+            bool bottomRight = offBottom && offRight && tiles[i - width + 1].type != 4;
+            bool topLeft = offTop && offLeft && tiles[i + width - 1].type != 4;
+            bool topRight = offTop && offRight && tiles[i + width + 1].type != 4;
+
+            tile.variant = bottom << 7 | top << 6 | left << 5 | right << 4 | bottomLeft << 3 | bottomRight << 2 | topLeft << 1 | topRight;
+        }
+    }
+}
+
+// Read a level in the legacy format, which has no header.
+
+static bool ReadLegacyLevel(const unsigned char* pData, size_t size, LevelFile& outLevel)
+{
+    ByteReader reader = {pData, size, 0};
+
+    // Read the environment of the level.
+
+    int biomeLength = 0;
+    reader.Read(&biomeLength, 4);
+
+    if (biomeLength < 0 || biomeLength > 255)
+    {
+        return false;
+    }
+
+    outLevel.biome.resize(biomeLength);
+    reader.Read(&outLevel.biome[0], biomeLength);
+
+    // Read the dimensions, start, finish, and dynamite count.
+
+    int fields[7] = {};
+    reader.Read(fields, sizeof(fields));
+
+    int width = fields[0];
+    int height = fields[1];
+    int dynamiteCount = fields[6];
+
+    if (width < 1 || height < 1 || width > maxLevelSize || height > maxLevelSize
+        || dynamiteCount < 0 || dynamiteCount > width * height)
+    {
+        return false;
+    }
+
+    outLevel.width = width;
+    outLevel.height = height;
+    outLevel.start = vector2f((float) fields[2] + 0.5f, (float) fields[3] + 0.5f);
+    outLevel.finish = vector2f((float) fields[4] + 0.5f, (float) fields[5] + 0.5f);
+
+    // Read all dynamite pick-up positions.
+
+    std::vector<int> positions(dynamiteCount * 2);
+    reader.Read(positions.data(), positions.size() * 4);
+
+    for (int i = 0; i < dynamiteCount; i++)
+    {
+        outLevel.dynamites.emplace_back((float) positions[i * 2] + 0.5f, (float) positions[i * 2 + 1] + 0.5f);
+    }
+
+    // Read the level's tile types and derive their variants.
+
+    std::vector<unsigned char> types(width * height);
+
+    if (!reader.Read(types.data(), types.size()))
+    {
+        return false;
+    }
+
+    outLevel.tiles.reserve(types.size());
+
+    for (unsigned char type : types)
+    {
+        outLevel.tiles.push_back({(int) type, 0});
+    }
+
+    BakeVariants(outLevel);
+
+    return true;
+}
+
+// Read a version 2 level straight from its bytes.
+
+static bool ReadLevel(const unsigned char* pData, size_t size, LevelFile& outLevel)
+{
+    LevelHeader header;
+
+    if (size < sizeof(LevelHeader))
+    {
+        return false;
+    }
+
+    memcpy(&header, pData, sizeof(LevelHeader));
+
+    // Validate the header against the file.
+
+    if (header.version != levelVersion)
+    {
+        ERR("Level version " << header.version << " is not supported.");
+
+        return false;
+    }
+
+    if (header.fileSize != size || Hash(pData + checksumEnd, size - checksumEnd) != header.checksum)
+    {
+        ERR("Level checksum does not match.");
+
+        return false;
+    }
+
+    int width = header.width;
+    int height = header.height;
+    int tileCount = width * height;
+
+    if (width < 1 || height < 1 || width > maxLevelSize || height > maxLevelSize
+        || header.dynamiteCount < 0 || header.dynamiteCount > tileCount
+        || memchr(header.biome, '\0', sizeof(header.biome)) == nullptr)
+    {
+        return false;
+    }
+
+    // Validate that the sections fill the rest of the file.
+
+    size_t dynamiteBytes = (size_t) header.dynamiteCount * 8;
+
+    if (sizeof(LevelHeader) + dynamiteBytes + header.tileBytes != size)
+    {
+        return false;
+    }
+
+    outLevel.biome = header.biome;
+    outLevel.width = width;
+    outLevel.height = height;
+    outLevel.start = vector2f((float) header.start[0] + 0.5f, (float) header.start[1] + 0.5f);
+    outLevel.finish = vector2f((float) header.finish[0] + 0.5f, (float) header.finish[1] + 0.5f);
+
+    // Copy the dynamite positions.
+
+    std::vector<int> positions(header.dynamiteCount * 2);
+    memcpy(positions.data(), pData + sizeof(LevelHeader), dynamiteBytes);
+
+    outLevel.dynamites.reserve(header.dynamiteCount);
+
+    for (int i = 0; i < header.dynamiteCount; i++)
+    {
+        outLevel.dynamites.emplace_back((float) positions[i * 2] + 0.5f, (float) positions[i * 2 + 1] + 0.5f);
+    }
+
+    // Expand the tiles, stored as type and variant pairs or as runs of them.
+
+    const unsigned char* pTiles = pData + sizeof(LevelHeader) + dynamiteBytes;
+    std::vector<Tile>& tiles = outLevel.tiles;
+
+    tiles.reserve(tileCount);
+
+    if (header.flags & compressedFlag)
+    {
+        if (header.tileBytes % 3 != 0)
+        {
+            return false;
+        }
+
+        for (unsigned int i = 0; i < header.tileBytes; i += 3)
+        {
+            int count = pTiles[i];
+
+            if (count > tileCount - (int) tiles.size())
+            {
+                return false;
+            }
+
+            tiles.insert(tiles.end(), count, {(int) pTiles[i + 1], (int) pTiles[i + 2]});
+        }
+    }
+    else
+    {
+        if (header.tileBytes != (unsigned int) tileCount * 2)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < tileCount; i++)
+        {
+            tiles.push_back({(int) pTiles[i * 2], (int) pTiles[i * 2 + 1]});
+        }
+    }
+
+    return (int) tiles.size() == tileCount;
+}
+
+// Read level data from the bytes of a level file;
+// Version 2 files are read in place, legacy files are still supported.
+
+bool ParseLevelFile(const unsigned char* pData, size_t size, LevelFile& outLevel)
+{
+    bool isVersioned = size >= 4 && memcmp(pData, levelMagic, 4) == 0;
+    bool valid = isVersioned ? ReadLevel(pData, size, outLevel) : ReadLegacyLevel(pData, size, outLevel);
+
+    // Validate the level's contents.
+
+    for (const Tile& tile : outLevel.tiles)
+    {
+        valid = valid && tile.type >= 0 && tile.type < tileTypeCount;
+    }
+
+    for (const vector2f& position : outLevel.dynamites)
+    {
+        valid = valid && IsInside((int) position.x, (int) position.y, outLevel.width, outLevel.height);
+    }
+
+    valid = valid && IsInside((int) outLevel.start.x, (int) outLevel.start.y, outLevel.width, outLevel.height)
+                  && IsInside((int) outLevel.finish.x, (int) outLevel.finish.y, outLevel.width, outLevel.height);
+
+    if (!valid)
+    {
+        outLevel = LevelFile();
+    }
+
+    return valid;
+}
+
+// Load level data from the asset pack or a file.
+
+bool LoadLevelFile(std::string_view path, LevelFile& outLevel)
+{
+    Asset file;
+
+    // Validate that the file was opened.
+
+    if (!file.Open(path))
+    {
+        ERR("Failed to load level from \"" << path << "\".");
+
+        return false;
+    }
+
+    if (!ParseLevelFile(file.GetData(), file.GetSize(), outLevel))
+    {
+        ERR("Level \"" << path << "\" is invalid or corrupt.");
+
+        return false;
+    }
+
+    LOG("Loaded level from \"" << path << "\".");
+
+    return true;
+}
+
+// Save level data to a file in the current version;
+// Compressed levels store runs of identical tiles.
+
+bool SaveLevelFile(std::string_view path, const LevelFile& level, bool compress)
+{
+    LevelHeader header = {};
+
+    memcpy(header.magic, levelMagic, 4);
+    header.version = levelVersion;
+    header.flags = compress ? compressedFlag : 0;
+    header.width = level.width;
+    header.height = level.height;
+    header.start[0] = (int) level.start.x;
+    header.start[1] = (int) level.start.y;
+    header.finish[0] = (int) level.finish.x;
+    header.finish[1] = (int) level.finish.y;
+    header.dynamiteCount = (int) level.dynamites.size();
+
+    level.biome.copy(header.biome, sizeof(header.biome) - 1);
+
+    // Write the dynamite positions.
+
+    std::vector<unsigned char> contents(sizeof(LevelHeader));
+
+    for (const vector2f& position : level.dynamites)
+    {
+        int coordinates[2] = {(int) position.x, (int) position.y};
+        const unsigned char* pBytes = (const unsigned char*) coordinates;
+
+        contents.insert(contents.end(), pBytes, pBytes + sizeof(coordinates));
+    }
+
+    // Write the tiles with their variants.
+
+    size_t tileStart = contents.size();
+
+    for (size_t i = 0; i < level.tiles.size(); i++)
+    {
+        const Tile& tile = level.tiles[i];
+
+        if (!compress)
+        {
+            contents.push_back((unsigned char) tile.type);
+            contents.push_back((unsigned char) tile.variant);
+
+            continue;
+        }
+
+        // Extend the previous run if the tile matches it.
+
+        size_t run = contents.size() - 3;
+
+        if (contents.size() > tileStart && contents[run] < 255
+            && contents[run + 1] == tile.type && contents[run + 2] == tile.variant)
+        {
+            contents[run]++;
+        }
+        else
+        {
+            contents.push_back(1);
+            contents.push_back((unsigned char) tile.type);
+            contents.push_back((unsigned char) tile.variant);
+        }
+    }
+
+    // Fill in the sizes and checksum, then write the file.
+
+    header.tileBytes = (unsigned int) (contents.size() - tileStart);
+    header.fileSize = (unsigned int) contents.size();
+
+    memcpy(contents.data(), &header, sizeof(LevelHeader));
+    header.checksum = Hash(contents.data() + checksumEnd, contents.size() - checksumEnd);
+    memcpy(contents.data(), &header, sizeof(LevelHeader));
+
+    std::ofstream file(path.data(), std::ios::binary);
+
+    if (!file.is_open())
+    {
+        ERR("Failed to save level to \"" << path << "\".");
+
+        return false;
+    }
+
+    file.write((const char*) contents.data(), (std::streamsize) contents.size());
+
+    LOG("Saved level to \"" << path << "\".");
+
+    return true;
+}
\ No newline at end of file
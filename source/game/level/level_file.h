@@ -0,0 +1,38 @@
+#ifndef LEVEL_FILE_H
+#define LEVEL_FILE_H
+
+#include "core/minimal.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Version of the level format written by SaveLevelFile;
+// Files without the level magic number are read as the legacy format.
+
+constexpr int levelVersion = 2;
+
+struct Tile
+{
+    int type;
+    int variant;
+};
+
+// Contents of a level file.
+
+struct LevelFile
+{
+    std::string biome;
+    int width;
+    int height;
+    vector2f start;
+    vector2f finish;
+
+    std::vector<vector2f> dynamites;
+    std::vector<Tile> tiles;
+};
+
+bool ParseLevelFile(const unsigned char* pData, size_t size, LevelFile& outLevel);
+bool LoadLevelFile(std::string_view path, LevelFile& outLevel);
+bool SaveLevelFile(std::string_view path, const LevelFile& level, bool compress);
+
+#endif
\ No newline at end of file
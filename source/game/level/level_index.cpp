@@ -0,0 +1,340 @@
+#include "level_index.h"
+#include "level_file.h"
+#include "level_list.h"
+#include "core/file/asset_pack.h"
+#include "core/hash.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+LevelIndex* pLevelIndex;
+
+// Index format identification.
+
+constexpr char indexMagic[4] = {'M', 'O', 'D', 'I'};
+constexpr int indexVersion = 2;
+
+// Modification time given to levels in the asset pack, which are checked by hash instead.
+
+constexpr long long packedTime = -1;
+
+// Longest name or biome read from an index, to reject corrupt lengths.
+
+constexpr int maxStringLength = 1024;
+
+// Read a length-prefixed string.
+
+static bool ReadString(std::ifstream& file, std::string& outString)
+{
+    int length = 0;
+    file.read((char*) &length, 4);
+
+    if (!file || length < 0 || length > maxStringLength)
+    {
+        return false;
+    }
+
+    outString.resize(length);
+    file.read(outString.data(), length);
+
+    return (bool) file;
+}
+
+// Write a length-prefixed string.
+
+static void WriteString(std::ofstream& file, const std::string& string)
+{
+    int length = (int) string.length();
+
+    file.write((const char*) &length, 4);
+    file.write(string.data(), length);
+}
+
+// Summarise a level from the bytes of its file;
+// A level that fails to parse is summarised as invalid, with no biome or size.
+
+static LevelInfo ReadInfo(std::string name, const unsigned char* pData, size_t size, long long modifiedTime)
+{
+    LevelFile file = {};
+
+    if (!ParseLevelFile(pData, size, file))
+    {
+        ERR("Level \"" << name << "\" is invalid or corrupt.");
+
+        return {std::move(name), "", 0, 0, false, modifiedTime, size, Hash(pData, size)};
+    }
+
+    return {std::move(name), file.biome, file.width, file.height, true, modifiedTime, size, Hash(pData, size)};
+}
+
+// Load the index from a file;
+// A missing or invalid index is rebuilt on the next refresh.
+
+LevelIndex::LevelIndex(std::string_view path)
+    : path(path)
+{
+    pLevelIndex = this;
+
+    std::ifstream file(path.data(), std::ios::binary);
+
+    if (!file.is_open())
+    {
+        LOG("No level index found, one will be generated.");
+
+        return;
+    }
+
+    char magic[4] = {};
+    int version = 0;
+    int count = 0;
+
+    file.read(magic, 4);
+    file.read((char*) &version, 4);
+    file.read((char*) &count, 4);
+
+    bool valid = file && memcmp(magic, indexMagic, 4) == 0 && version == indexVersion && count >= 0;
+
+    for (int i = 0; valid && i < count; i++)
+    {
+        LevelInfo info = {};
+
+        valid = ReadString(file, info.name) && ReadString(file, info.biome);
+
+        file.read((char*) &info.width, 4);
+        file.read((char*) &info.height, 4);
+        info.valid = file.get() == 1;
+        file.read((char*) &info.modifiedTime, 8);
+        file.read((char*) &info.size, 8);
+        file.read((char*) &info.hash, 8);
+
+        valid = valid && file;
+        levels.push_back(std::move(info));
+    }
+
+    // Keep the levels sorted by name for lookups.
+
+    std::sort(levels.begin(), levels.end(), [](const LevelInfo& a, const LevelInfo& b) { return a.name < b.name; });
+
+    if (!valid)
+    {
+        ERR("Level index \"" << path << "\" is invalid or corrupt, it will be regenerated.");
+
+        levels.clear();
+
+        return;
+    }
+
+    LOG("Loaded level index from \"" << path << "\".");
+}
+
+// Bring the index up to date with the packed and loose levels;
+// Loose levels are checked by their directory entries, without opening them.
+
+void LevelIndex::Refresh()
+{
+    START_METRIC("level_index_refresh");
+
+    std::vector<LevelInfo> refreshed;
+    int parsedCount = 0;
+
+    // Packed levels are checked by the hash of their bytes, which are already in memory.
+
+    if (pAssetPack)
+    {
+        for (std::string& name : pAssetPack->List("levels/", ".level"))
+        {
+            const unsigned char* pData;
+            size_t size;
+            pAssetPack->Find("levels/" + name + ".level", pData, size);
+
+            const LevelInfo* pKnown = Find(name);
+
+            if (pKnown && pKnown->modifiedTime == packedTime && pKnown->hash == Hash(pData, size))
+            {
+                refreshed.push_back(*pKnown);
+            }
+            else
+            {
+                refreshed.push_back(ReadInfo(std::move(name), pData, size, packedTime));
+                parsedCount++;
+            }
+        }
+    }
+
+    // Loose levels with the same name as packed ones are never loaded.
+
+    size_t packedCount = refreshed.size();
+    auto isPacked = [&](const std::string& name)
+    {
+        auto end = refreshed.begin() + (std::ptrdiff_t) packedCount;
+
+        return std::find_if(refreshed.begin(), end, [&](const LevelInfo& info) { return info.name == name; }) != end;
+    };
+
+    std::error_code error;
+
+    for (const auto& entry : std::filesystem::directory_iterator("levels", error))
+    {
+        if (entry.path().extension() != ".level")
+        {
+            continue;
+        }
+
+        std::string name = entry.path().stem().string();
+
+        if (isPacked(name))
+        {
+            continue;
+        }
+
+        long long modifiedTime = (long long) entry.last_write_time(error).time_since_epoch().count();
+        unsigned long long size = (unsigned long long) entry.file_size(error);
+
+        const LevelInfo* pKnown = Find(name);
+
+        if (pKnown && pKnown->modifiedTime == modifiedTime && pKnown->size == size)
+        {
+            refreshed.push_back(*pKnown);
+
+            continue;
+        }
+
+        // Parse the level only when it is new or changed.
+
+        Asset file;
+
+        if (file.Open(entry.path().generic_string()))
+        {
+            LevelInfo info = ReadInfo(std::move(name), file.GetData(), file.GetSize(), modifiedTime);
+            info.size = size;
+
+            refreshed.push_back(std::move(info));
+            parsedCount++;
+        }
+    }
+
+    std::sort(refreshed.begin(), refreshed.end(), [](const LevelInfo& a, const LevelInfo& b) { return a.name < b.name; });
+
+    // Save the index if any level was added, changed or removed.
+
+    bool changed = parsedCount > 0 || refreshed.size() != levels.size();
+    levels.swap(refreshed);
+
+    if (changed)
+    {
+        Save();
+    }
+
+    STOP_METRIC("level_index_refresh");
+
+    LOG("Refreshed the level index (" << levels.size() << " levels, " << parsedCount << " parsed).");
+}
+
+// Find a level's summary by name.
+
+const LevelInfo* LevelIndex::Find(std::string_view name) const
+{
+    auto compare = [](const LevelInfo& info, std::string_view value) { return info.name < value; };
+    auto location = std::lower_bound(levels.begin(), levels.end(), name, compare);
+
+    if (location != levels.end() && location->name == name)
+    {
+        return &*location;
+    }
+
+    return nullptr;
+}
+
+// Get every level's summary in a sort order;
+// The default order lists the base game levels first, in the order they are played;
+// Sorting by size lists invalid levels last, as they have no size.
+
+std::vector<const LevelInfo*> LevelIndex::GetSorted(LevelSort sort) const
+{
+    std::vector<const LevelInfo*> sorted;
+    sorted.reserve(levels.size());
+
+    for (const LevelInfo& info : levels)
+    {
+        sorted.push_back(&info);
+    }
+
+    auto baseIndex = [](const LevelInfo* pInfo)
+    {
+        return std::find(std::begin(levelList), std::end(levelList), pInfo->name) - std::begin(levelList);
+    };
+
+    // Levels are already sorted by name, so a stable sort keeps names in order within each key.
+
+    switch (sort)
+    {
+        case SORT_DEFAULT:
+            std::stable_sort(sorted.begin(), sorted.end(), [&](const LevelInfo* a, const LevelInfo* b) { return baseIndex(a) < baseIndex(b); });
+            break;
+
+        case SORT_BIOME:
+            std::stable_sort(sorted.begin(), sorted.end(), [](const LevelInfo* a, const LevelInfo* b) { return a->biome < b->biome; });
+            break;
+
+        case SORT_SIZE:
+            std::stable_sort(sorted.begin(), sorted.end(), [](const LevelInfo* a, const LevelInfo* b)
+            {
+                return a->valid != b->valid ? a->valid : a->width * a->height < b->width * b->height;
+            });
+            break;
+
+        default:
+            break;
+    }
+
+    return sorted;
+}
+
+// Get the number of levels in the index.
+
+int LevelIndex::GetCount() const
+{
+    return (int) levels.size();
+}
+
+// Save the index to a file.
+
+void LevelIndex::Save() const
+{
+    // Generate a directory for the index.
+
+    std::filesystem::path directory(path);
+    std::error_code error;
+    std::filesystem::create_directories(directory.remove_filename(), error);
+
+    std::ofstream file(path.data(), std::ios::binary);
+
+    if (!file.is_open())
+    {
+        ERR("Failed to save level index to \"" << path << "\".");
+
+        return;
+    }
+
+    int count = (int) levels.size();
+
+    file.write(indexMagic, 4);
+    file.write((const char*) &indexVersion, 4);
+    file.write((const char*) &count, 4);
+
+    for (const LevelInfo& info : levels)
+    {
+        WriteString(file, info.name);
+        WriteString(file, info.biome);
+
+        file.write((const char*) &info.width, 4);
+        file.write((const char*) &info.height, 4);
+        file.put((char) info.valid);
+        file.write((const char*) &info.modifiedTime, 8);
+        file.write((const char*) &info.size, 8);
+        file.write((const char*) &info.hash, 8);
+    }
+
+    LOG("Saved level index to \"" << path << "\".");
+}
\ No newline at end of file
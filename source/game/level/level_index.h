@@ -0,0 +1,58 @@
+#ifndef LEVEL_INDEX_H
+#define LEVEL_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+extern class LevelIndex* pLevelIndex;
+
+// Summary of a level file, enough to list it without reading the file;
+// Levels whose file could not be parsed are kept as invalid, so they are not parsed again until they change.
+
+struct LevelInfo
+{
+    std::string name;
+    std::string biome;
+    int width;
+    int height;
+    bool valid;
+
+    long long modifiedTime;
+    unsigned long long size;
+    unsigned long long hash;
+};
+
+// Orders a list of levels can be sorted in.
+
+enum LevelSort
+{
+    SORT_DEFAULT,
+    SORT_NAME,
+    SORT_BIOME,
+    SORT_SIZE
+};
+
+// Persistent index of every level's summary;
+// Refreshing only parses levels whose size, modification time or packed contents changed.
+
+class LevelIndex
+{
+public:
+    LevelIndex(std::string_view path);
+
+    void Refresh();
+
+    const LevelInfo* Find(std::string_view name) const;
+    std::vector<const LevelInfo*> GetSorted(LevelSort sort) const;
+    int GetCount() const;
+
+private:
+    void Save() const;
+
+    std::string_view path;
+
+    std::vector<LevelInfo> levels;
+};
+
+#endif
\ No newline at end of file
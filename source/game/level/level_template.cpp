@@ -0,0 +1,137 @@
+#include "level_template.h"
+#include "core/video/renderer.h"
+#include "game/replay/replay.h"
+#include <future>
+#include <unordered_map>
+
+// Contents of a level read from disk, before its sprites are looked up.
+
+struct LevelData
+{
+    unsigned long long hash;
+    bool loaded;
+
+    LevelFile file;
+    Image biomeImage;
+};
+
+// Templates of every level loaded so far, by name.
+
+static std::unordered_map<std::string, std::shared_ptr<const LevelTemplate>> templates;
+
+// Level being read in the background, if any.
+
+static std::string prefetchName;
+static std::future<LevelData> prefetch;
+
+// Read a level's file and hash, and optionally decode its biome's sprite sheet;
+// Only touches the disk, so it can run on any thread.
+
+static LevelData ReadLevel(const std::string& name, bool decodeBiome)
+{
+    LevelData data = {};
+    data.hash = Replay::HashLevel(name);
+    data.loaded = LoadLevelFile("levels/" + name + ".level", data.file);
+
+    if (decodeBiome)
+    {
+        LoadImageFile("assets/sprites/level/" + data.file.biome + ".bmp", data.biomeImage);
+    }
+
+    return data;
+}
+
+// Get a level's template, loading it on first use;
+// Returns null if the level fails to load, which is not cached so it is retried next time.
+
+std::shared_ptr<const LevelTemplate> LevelTemplate::Get(std::string_view name)
+{
+    std::string key(name);
+    auto location = templates.find(key);
+
+    if (location != templates.end())
+    {
+        return location->second;
+    }
+
+    // Take the level from its prefetch, which has usually finished, or load it from a file.
+
+    LevelData data;
+    bool prefetched = prefetch.valid() && prefetchName == key;
+
+    if (prefetched)
+    {
+        data = prefetch.get();
+    }
+    else
+    {
+        data = ReadLevel(key, false);
+    }
+
+    if (!data.loaded)
+    {
+        return nullptr;
+    }
+
+    auto pTemplate = std::make_shared<LevelTemplate>();
+    pTemplate->name = key;
+    pTemplate->hash = data.hash;
+    pTemplate->file = std::move(data.file);
+
+    // Look up the tile sprites for the level's biome.
+
+    const Image* pBiomeImage = prefetched ? &data.biomeImage : nullptr;
+    SpriteSheet levelSheet = pRenderer->GetSheet("assets/sprites/level/" + pTemplate->file.biome + ".bmp", pBiomeImage);
+    SpriteSheet wallSheet = pRenderer->GetSheet("assets/sprites/level/walls.bmp");
+
+    for (int i = 0; i < 10; i++)
+    {
+        int x = (i % 4) * 8;
+        int y = (i / 4) * 8;
+
+        pTemplate->sprites[i] = levelSheet.GetSprite(x, y, 8, 8);
+    }
+
+    for (int i = 0; i < 256; i++)
+    {
+        int x = (i % 16) * 8;
+        int y = (i / 16) * 8;
+
+        pTemplate->sprites[i + 10] = wallSheet.GetSprite(x, y, 8, 8);
+    }
+
+    templates[key] = pTemplate;
+
+    return pTemplate;
+}
+
+// Start reading a level in the background, so getting its template later does not wait on the disk;
+// A different level still being read is waited for first.
+
+void LevelTemplate::Prefetch(std::string_view name)
+{
+    std::string key(name);
+
+    if (templates.count(key) > 0 || (prefetch.valid() && prefetchName == key))
+    {
+        return;
+    }
+
+    prefetchName = key;
+    prefetch = std::async(std::launch::async, ReadLevel, key, true);
+}
+
+// Forget every cached template, so levels are loaded again on next use;
+// Waits for a level still being read, which must finish before the asset pack is closed.
+
+void LevelTemplate::ClearCache()
+{
+    if (prefetch.valid())
+    {
+        prefetch.wait();
+    }
+
+    prefetch = {};
+    prefetchName.clear();
+    templates.clear();
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef LEVEL_TEMPLATE_H
+#define LEVEL_TEMPLATE_H
+
+#include "level_file.h"
+#include "core/minimal.h"
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Immutable parsed contents and resources of a level;
+// Cached by name and shared by every run of the level, so runs start without any I/O.
+
+struct LevelTemplate
+{
+    std::string name;
+    unsigned long long hash;
+
+    LevelFile file;
+    Sprite sprites[266];
+
+    static std::shared_ptr<const LevelTemplate> Get(std::string_view name);
+    static void Prefetch(std::string_view name);
+    static void ClearCache();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "tile_collision.h"
+#include "level.h"
+
+// The most contacts resolved for one box in a single update.
+
+constexpr int maxContacts = 4;
+
+// Check a column of tiles for a solid one.
+
+static bool IsColumnSolid(int x, float bottom, float top)
+{
+    int first = (int) floorf(bottom);
+    int last = (int) ceilf(top) - 1;
+
+    for (int y = first; y <= last; y++)
+    {
+        if (pLevel->IsSolid(x, y))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Check a row of tiles for a solid one.
+
+static bool IsRowSolid(int y, float left, float right)
+{
+    int first = (int) floorf(left);
+    int last = (int) ceilf(right) - 1;
+
+    for (int x = first; x <= last; x++)
+    {
+        if (pLevel->IsSolid(x, y))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Sweep a box along a motion and find the first solid tile it enters;
+// Walks the tile boundaries crossed by the leading edges in order of time.
+
+bool SweepBox(vector2f position, vector2f halfSize, vector2f motion, TileHit& outHit)
+{
+    constexpr float never = 2.0f;
+
+    // Find the first boundary each leading edge crosses and the time between boundaries.
+
+    float edgeX = position.x + (motion.x > 0.0f ? halfSize.x : -halfSize.x);
+    float edgeY = position.y + (motion.y > 0.0f ? halfSize.y : -halfSize.y);
+
+    float boundaryX = motion.x > 0.0f ? ceilf(edgeX) : floorf(edgeX);
+    float boundaryY = motion.y > 0.0f ? ceilf(edgeY) : floorf(edgeY);
+    float stepX = motion.x > 0.0f ? 1.0f : -1.0f;
+    float stepY = motion.y > 0.0f ? 1.0f : -1.0f;
+
+    float timeX = motion.x != 0.0f ? (boundaryX - edgeX) / motion.x : never;
+    float timeY = motion.y != 0.0f ? (boundaryY - edgeY) / motion.y : never;
+    float deltaX = motion.x != 0.0f ? 1.0f / Abs(motion.x) : never;
+    float deltaY = motion.y != 0.0f ? 1.0f / Abs(motion.y) : never;
+
+    // Step to whichever boundary is crossed next until the motion is used up.
+
+    while (timeX <= 1.0f || timeY <= 1.0f)
+    {
+        if (timeX <= timeY)
+        {
+            // The box enters a new column of tiles.
+
+            float offset = motion.y * timeX;
+            int column = (int) boundaryX - (motion.x > 0.0f ? 0 : 1);
+
+            if (IsColumnSolid(column, position.y - halfSize.y + offset, position.y + halfSize.y + offset))
+            {
+                outHit = {timeX, boundaryX, 0};
+
+                return true;
+            }
+
+            boundaryX += stepX;
+            timeX += deltaX;
+        }
+        else
+        {
+            // The box enters a new row of tiles.
+
+            float offset = motion.x * timeY;
+            int row = (int) boundaryY - (motion.y > 0.0f ? 0 : 1);
+
+            if (IsRowSolid(row, position.x - halfSize.x + offset, position.x + halfSize.x + offset))
+            {
+                outHit = {timeY, boundaryY, 1};
+
+                return true;
+            }
+
+            boundaryY += stepY;
+            timeY += deltaY;
+        }
+    }
+
+    return false;
+}
+
+// Move a box by its velocity, stopping at solid tiles;
+// The velocity along a hit axis is reflected and scaled by the restitution.
+
+void MoveBox(vector2f& position, vector2f& velocity, vector2f halfSize, float restitution, float delta)
+{
+    float remaining = delta;
+
+    for (int i = 0; i < maxContacts && remaining > 0.0f; i++)
+    {
+        vector2f motion = velocity * remaining;
+        TileHit hit = {};
+
+        if (!SweepBox(position, halfSize, motion, hit))
+        {
+            position += motion;
+
+            return;
+        }
+
+        // Move up to the contact, keeping a small gap from the tile.
+
+        if (hit.axis == 0)
+        {
+            position.y += motion.y * hit.time;
+            position.x = hit.boundary + (motion.x > 0.0f ? -halfSize.x - epsilon : halfSize.x + epsilon);
+            velocity.x *= -restitution;
+        }
+        else
+        {
+            position.x += motion.x * hit.time;
+            position.y = hit.boundary + (motion.y > 0.0f ? -halfSize.y - epsilon : halfSize.y + epsilon);
+            velocity.y *= -restitution;
+        }
+
+        remaining -= remaining * hit.time;
+    }
+}
\ No newline at end of file
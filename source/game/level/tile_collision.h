@@ -0,0 +1,18 @@
+#ifndef TILE_COLLISION_H
+#define TILE_COLLISION_H
+
+#include "core/minimal.h"
+
+// Earliest contact of a box swept through the level's tiles.
+
+struct TileHit
+{
+    float time;
+    float boundary;
+    int axis;
+};
+
+bool SweepBox(vector2f position, vector2f halfSize, vector2f motion, TileHit& outHit);
+void MoveBox(vector2f& position, vector2f& velocity, vector2f halfSize, float restitution, float delta);
+
+#endif
\ No newline at end of file
@@ -26,8 +26,10 @@ LevelCompleteMenu::LevelCompleteMenu(int index, std::string_view name)
 
 void LevelCompleteMenu::OnPressNext()
 {
-    Level::Load(levelList[completedIndex + 1]);
-    Menu::Close();
+    if (Level::Load(levelList[completedIndex + 1]))
+    {
+        Menu::Close();
+    }
 }
 
 // Press retry callback.
@@ -2,40 +2,25 @@
 #include "game/level/level.h"
 #include "game/level/level_list.h"
 #include "game/menu/main_menu.h"
+#include "game/menu/thumbnail_cache.h"
 #include "game/save/save_slot.h"
-#include <filesystem>
+#include <iterator>
 
 // Initialise the menu.
 
 LevelSelectMenu::LevelSelectMenu()
-    : currentPage(0)
+    : currentPage(0), sort(SORT_DEFAULT)
 {
-    levels.reserve(levelCount);
+    // Bring the level index up to date, parsing only new or changed levels.
 
-    // Preload all level names and page count.
-
-    for (std::string_view name : levelList)
+    if (pLevelIndex)
     {
-        levels.emplace_back(name);
+        pLevelIndex->Refresh();
     }
 
-    for (const auto& file : std::filesystem::directory_iterator("levels"))
-    {
-        if (file.path().extension() == ".level")
-        {
-            std::string name = file.path().stem().string();
-
-            if (std::find(levels.begin(), levels.end(), name) == levels.end())
-            {
-                levels.push_back(name);
-            }
-        }
-    }
-
-    totalPages = ((int) levels.size() - 1) / 9 + 1;
-
     // Draw the menu widgets.
 
+    ListLevels();
     RefreshMenu();
 
     // Pressing escape goes back.
@@ -43,6 +28,15 @@ LevelSelectMenu::LevelSelectMenu()
     SetEscapeCallback(std::bind(&LevelSelectMenu::OnPressBack, this));
 }
 
+// Update the menu;
+// Thumbnails are added first, as pressing a button may close the menu.
+
+void LevelSelectMenu::Update(float delta)
+{
+    AddThumbnails();
+    Menu::Update(delta);
+}
+
 // Press back callback.
 
 void LevelSelectMenu::OnPressBack()
@@ -72,32 +66,79 @@ void LevelSelectMenu::OnPressNext()
     }
 }
 
+// Press sort callback.
+
+void LevelSelectMenu::OnPressSort()
+{
+    sort = (LevelSort) ((sort + 1) % (SORT_SIZE + 1));
+    currentPage = 0;
+
+    ListLevels();
+    RefreshMenu();
+}
+
 // Select level callback.
 
 void LevelSelectMenu::OnSelectLevel(int index)
 {
     std::string_view name = levels[currentPage * 9 + index];
 
-    // Load the level if it is unlocked.
+    // Load the level if it is unlocked and valid, staying on the menu if it cannot be loaded.
 
-    if (pSave->IsLevelUnlocked(name))
+    if (pSave->IsLevelUnlocked(name) && IsLevelValid(name) && Level::Load(name))
     {
-        Level::Load(name);
         Menu::Close();
     }
 }
 
+// Check if a level can be played, which without an index is assumed.
+
+bool LevelSelectMenu::IsLevelValid(std::string_view name) const
+{
+    const LevelInfo* pInfo = pLevelIndex ? pLevelIndex->Find(name) : nullptr;
+
+    return !pInfo || pInfo->valid;
+}
+
+// List the level names in the current sort order;
+// Without an index only the base game levels are listed.
+
+void LevelSelectMenu::ListLevels()
+{
+    levels.clear();
+
+    if (pLevelIndex)
+    {
+        for (const LevelInfo* pInfo : pLevelIndex->GetSorted(sort))
+        {
+            levels.push_back(pInfo->name);
+        }
+    }
+    else
+    {
+        levels.assign(std::begin(levelList), std::end(levelList));
+    }
+
+    totalPages = ((int) levels.size() - 1) / 9 + 1;
+}
+
 // Refresh the menu widgets.
 
 void LevelSelectMenu::RefreshMenu()
 {
     ClearWidgets();
+    pendingThumbnails.clear();
 
     // Page indicator.
 
     std::string pageString = "Page " + std::to_string(currentPage + 1) + " of " + std::to_string(totalPages);
     AddString(-6.25f, 4.25f, pageString, 0.0f);
 
+    // Sort order button.
+
+    const char* sortNames[] = {"Default", "By name", "By biome", "By size"};
+    AddSmallButton(4.25f, 4.25f, std::bind(&LevelSelectMenu::OnPressSort, this), sortNames[sort], 0.5f);
+
     // Navigation buttons.
 
     AddSmallButton(-4.25f, -4.25f, std::bind(&LevelSelectMenu::OnPressBack, this),     "Back",     0.5f);
@@ -119,7 +160,11 @@ void LevelSelectMenu::RefreshMenu()
 
         // Choose a level status.
 
-        if (pSave->IsLevelCompleted(name))
+        if (!IsLevelValid(name))
+        {
+            text[1] = "Invalid";
+        }
+        else if (pSave->IsLevelCompleted(name))
         {
             text[1] = Level::TimeToString(pSave->GetLevelTime(name));
         }
@@ -133,5 +178,62 @@ void LevelSelectMenu::RefreshMenu()
         }
 
         AddLargeButton(x, y, std::bind(&LevelSelectMenu::OnSelectLevel, this, i), text, 0.0f);
+
+        // Shorten the text to leave room for a thumbnail.
+
+        widgets[widgets.size() - 1].maxLength = 7;
+        widgets[widgets.size() - 2].maxLength = 7;
+        pendingThumbnails.push_back(i);
+    }
+
+    AddThumbnails();
+}
+
+// Add the thumbnails of listed levels that are ready;
+// Those that are not are requested, so the menu never waits for them, and invalid levels have none.
+
+void LevelSelectMenu::AddThumbnails()
+{
+    if (!pThumbnails || !pLevelIndex)
+    {
+        return;
+    }
+
+    pThumbnails->Update();
+
+    auto location = pendingThumbnails.begin();
+
+    while (location != pendingThumbnails.end())
+    {
+        int i = *location;
+        const LevelInfo* pInfo = pLevelIndex->Find(levels[currentPage * 9 + i]);
+
+        if (pInfo && !pInfo->valid)
+        {
+            pInfo = nullptr;
+        }
+
+        SpriteSheet sheet;
+
+        if (pInfo && !pThumbnails->GetThumbnail(pInfo->name, pInfo->hash, sheet))
+        {
+            location++;
+
+            continue;
+        }
+
+        // Fit the thumbnail into the right of its button.
+
+        if (pInfo)
+        {
+            float x = (float) (i % 3 - 1) * 4.25f + 1.4f;
+            float y = (float) (i / 3 - 1) * -2.25f;
+            float scale = 1.0f / (float) Max(sheet.imageWidth, sheet.imageHeight);
+
+            Sprite sprite = sheet.GetSprite(0, 0, sheet.imageWidth, sheet.imageHeight);
+            AddImage(x, y, (float) sheet.imageWidth * scale, (float) sheet.imageHeight * scale, sprite);
+        }
+
+        location = pendingThumbnails.erase(location);
     }
 }
\ No newline at end of file
@@ -2,25 +2,35 @@
 #define LEVEL_SELECT_MENU_H
 
 #include "menu.h"
+#include "game/level/level_index.h"
 
 class LevelSelectMenu : public Menu
 {
 public:
     LevelSelectMenu();
 
+    void Update(float delta) override;
+
 private:
     void OnPressBack();
     void OnPressPrevious();
     void OnPressNext();
+    void OnPressSort();
     void OnSelectLevel(int index);
 
+    void ListLevels();
     void RefreshMenu();
+    void AddThumbnails();
+    bool IsLevelValid(std::string_view name) const;
 
 private:
     int currentPage;
     int totalPages;
 
+    LevelSort sort;
+
     std::vector<std::string> levels;
+    std::vector<int> pendingThumbnails;
 };
 
 #endif
\ No newline at end of file
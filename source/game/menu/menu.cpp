@@ -21,8 +21,8 @@ Menu::Menu()
     sprites[2] = sheet.GetSprite(0, 16, 64, 32);
     sprites[3] = sheet.GetSprite(64, 16, 64, 32);
 
-    hoverSound = pSoundMixer->GetSound("assets/sounds/button_hover.wav");
-    pressSound = pSoundMixer->GetSound("assets/sounds/button_press.wav");
+    hoverSound = pSoundMixer->GetSound("assets/sounds/button_hover.wav", 2, 1, 0.05f);
+    pressSound = pSoundMixer->GetSound("assets/sounds/button_press.wav", 2, 1);
 }
 
 // Update the menu.
@@ -101,6 +101,13 @@ void Menu::Render() const
             pRenderer->DrawSprite(sprite, widget.position.x, widget.position.y, 3.5f, widget.bounds.x, widget.bounds.y);
         }
 
+        // Draw the widget's image.
+
+        else if (widget.type == IMAGE)
+        {
+            pRenderer->DrawSprite(widget.image, widget.position.x, widget.position.y, 3.75f, widget.bounds.x, widget.bounds.y);
+        }
+
         // Draw the widget's string.
 
         else
@@ -163,6 +170,16 @@ void Menu::AddString(float x, float y, std::string string, float alignment)
     widgets.push_back({STRING, position, bounds, nullptr, 0, std::move(string), alignment, 0.0f, 0});
 }
 
+// Add an image widget, centred on a position.
+
+void Menu::AddImage(float x, float y, float w, float h, const Sprite& image)
+{
+    vector2f bounds(w, h);
+    vector2f position = vector2f(x, y) - bounds * 0.5f;
+
+    widgets.push_back({IMAGE, position, bounds, nullptr, 0, "", 0.0f, 0.0f, 0, image});
+}
+
 // Clear the menu widgets.
 
 void Menu::ClearWidgets()
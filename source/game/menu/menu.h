@@ -10,7 +10,8 @@
 enum WidgetType
 {
     BUTTON,
-    STRING
+    STRING,
+    IMAGE
 };
 
 struct Widget
@@ -32,6 +33,10 @@ struct Widget
     float alignment;
     float scrollTime;
     int maxLength;
+
+    // Image widget.
+
+    Sprite image;
 };
 
 extern std::shared_ptr<class Menu> pMenu;
@@ -42,13 +47,14 @@ public:
     Menu();
     virtual ~Menu() = default;
 
-    void Update(float delta);
+    virtual void Update(float delta);
     void Render() const;
 
 protected:
     void AddSmallButton(float x, float y, std::function<void(int)> pOnPress, std::string string, float alignment);
     void AddLargeButton(float x, float y, std::function<void(int)> pOnPress, std::string string[2], float alignment);
     void AddString(float x, float y, std::string string, float alignment);
+    void AddImage(float x, float y, float w, float h, const Sprite& image);
     void ClearWidgets();
     void SetEscapeCallback(std::function<void()> pCallback);
 
@@ -0,0 +1,306 @@
+#include "thumbnail_cache.h"
+#include "core/logging.h"
+#include "core/video/renderer.h"
+#include "game/level/level_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+ThumbnailCache* pThumbnails;
+
+// Thumbnail file identification.
+
+constexpr char thumbnailMagic[4] = {'M', 'O', 'D', 'T'};
+constexpr int thumbnailVersion = 1;
+
+// Colours of each tile type, then of the start, finish, and dynamite pick-ups.
+
+constexpr unsigned char tileColours[5][4] =
+{
+    { 86, 128,  66, 255},
+    {128, 128, 136, 255},
+    {156, 104,  52, 255},
+    {204,  52,  44, 255},
+    { 44,  44,  52, 255}
+};
+
+constexpr unsigned char startColour[4] = { 64, 144, 232, 255};
+constexpr unsigned char finishColour[4] = {240, 212,  64, 255};
+constexpr unsigned char dynamiteColour[4] = {236, 124,  44, 255};
+
+// Ground colours of biomes that differ from the default.
+
+struct BiomeColour
+{
+    std::string_view biome;
+    unsigned char colour[4];
+};
+
+constexpr BiomeColour biomeColours[] =
+{
+    {"sand", {196, 174, 112, 255}}
+};
+
+// Fill the pixels of a level's tile in a thumbnail.
+
+static void FillTile(std::vector<unsigned char>& pixels, int width, int scale, int x, int y, const unsigned char colour[4])
+{
+    for (int row = y * scale; row < (y + 1) * scale; row++)
+    {
+        for (int column = x * scale; column < (x + 1) * scale; column++)
+        {
+            memcpy(&pixels[((size_t) row * width + column) * 4], colour, 4);
+        }
+    }
+}
+
+// Draw a level's tiles into a thumbnail no larger than the thumbnail size;
+// Small levels get a block of pixels per tile, large ones a pixel per block of tiles showing its most common type.
+
+static void DrawThumbnail(const LevelFile& level, int& outWidth, int& outHeight, std::vector<unsigned char>& outPixels)
+{
+    int levelSize = Max(Max(level.width, level.height), 1);
+    int scale = Max(thumbnailSize / levelSize, 1);
+    int step = (levelSize + thumbnailSize - 1) / thumbnailSize;
+
+    int columns = (level.width + step - 1) / step;
+    int rows = (level.height + step - 1) / step;
+    int width = columns * scale;
+    int height = rows * scale;
+
+    const unsigned char* pGround = tileColours[0];
+
+    for (const BiomeColour& biomeColour : biomeColours)
+    {
+        if (biomeColour.biome == level.biome)
+        {
+            pGround = biomeColour.colour;
+        }
+    }
+
+    outPixels.assign((size_t) width * height * 4, 0);
+
+    // Tiles are stored from the bottom row up, as are texture rows.
+
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++)
+        {
+            int counts[5] = {};
+
+            for (int y = row * step; y < Min((row + 1) * step, level.height); y++)
+            {
+                for (int x = column * step; x < Min((column + 1) * step, level.width); x++)
+                {
+                    counts[level.tiles[y * level.width + x].type]++;
+                }
+            }
+
+            int type = (int) (std::max_element(counts, counts + 5) - counts);
+
+            FillTile(outPixels, width, scale, column, row, type == 0 ? pGround : tileColours[type]);
+        }
+    }
+
+    for (const vector2f& position : level.dynamites)
+    {
+        FillTile(outPixels, width, scale, (int) position.x / step, (int) position.y / step, dynamiteColour);
+    }
+
+    FillTile(outPixels, width, scale, (int) level.start.x / step, (int) level.start.y / step, startColour);
+    FillTile(outPixels, width, scale, (int) level.finish.x / step, (int) level.finish.y / step, finishColour);
+
+    outWidth = width;
+    outHeight = height;
+}
+
+// Initialise the cache and start its worker thread.
+
+ThumbnailCache::ThumbnailCache(std::string_view directory)
+    : directory(directory), stopping(false)
+{
+    pThumbnails = this;
+
+    worker = std::thread(&ThumbnailCache::Work, this);
+}
+
+// Stop the worker thread, abandoning any thumbnails not yet started.
+
+ThumbnailCache::~ThumbnailCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_one();
+    worker.join();
+}
+
+// Upload any thumbnails the worker thread has finished.
+
+void ThumbnailCache::Update()
+{
+    std::vector<Thumbnail> ready;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(finished);
+    }
+
+    for (const Thumbnail& thumbnail : ready)
+    {
+        SpriteSheet& sheet = sheets[thumbnail.levelHash];
+
+        // Levels that failed to load keep an empty sheet so they are not requested again.
+
+        if (!thumbnail.pixels.empty())
+        {
+            sheet = pRenderer->CreateSheet(thumbnail.pixels.data(), thumbnail.width, thumbnail.height);
+        }
+    }
+}
+
+// Get a level's thumbnail if it is ready;
+// Otherwise it is requested from the worker thread, without waiting for it.
+
+bool ThumbnailCache::GetThumbnail(std::string_view levelName, unsigned long long levelHash, SpriteSheet& outSheet)
+{
+    auto location = sheets.find(levelHash);
+
+    if (location != sheets.end())
+    {
+        outSheet = location->second;
+
+        return outSheet.imageWidth > 0;
+    }
+
+    // Mark the thumbnail as requested with an empty sheet.
+
+    sheets[levelHash] = {0, 0, 0};
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back({std::string(levelName), levelHash, 0, 0, {}});
+    }
+
+    condition.notify_one();
+
+    return false;
+}
+
+// Load or draw requested thumbnails until stopped.
+
+void ThumbnailCache::Work()
+{
+    while (true)
+    {
+        Thumbnail thumbnail;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !requests.empty(); });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            thumbnail = std::move(requests.front());
+            requests.pop_front();
+        }
+
+        // Draw the thumbnail from the level if it is not cached on disk.
+
+        if (!LoadThumbnail(thumbnail))
+        {
+            LevelFile level = {};
+
+            if (LoadLevelFile("levels/" + thumbnail.levelName + ".level", level))
+            {
+                DrawThumbnail(level, thumbnail.width, thumbnail.height, thumbnail.pixels);
+                SaveThumbnail(thumbnail);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.push_back(std::move(thumbnail));
+    }
+}
+
+// Load a thumbnail from disk, if it was saved and is valid.
+
+bool ThumbnailCache::LoadThumbnail(Thumbnail& thumbnail) const
+{
+    std::ifstream file(GetPath(thumbnail.levelHash), std::ios::binary);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    char magic[4] = {};
+    int version = 0;
+    int width = 0;
+    int height = 0;
+
+    file.read(magic, 4);
+    file.read((char*) &version, 4);
+    file.read((char*) &width, 4);
+    file.read((char*) &height, 4);
+
+    if (!file || memcmp(magic, thumbnailMagic, 4) != 0 || version != thumbnailVersion
+        || width < 1 || height < 1 || width > thumbnailSize || height > thumbnailSize)
+    {
+        return false;
+    }
+
+    std::vector<unsigned char> pixels((size_t) width * height * 4);
+    file.read((char*) pixels.data(), (std::streamsize) pixels.size());
+
+    if (!file)
+    {
+        return false;
+    }
+
+    thumbnail.width = width;
+    thumbnail.height = height;
+    thumbnail.pixels = std::move(pixels);
+
+    return true;
+}
+
+// Save a thumbnail to disk so it is not drawn again.
+
+void ThumbnailCache::SaveThumbnail(const Thumbnail& thumbnail) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    std::ofstream file(GetPath(thumbnail.levelHash), std::ios::binary);
+
+    if (!file.is_open())
+    {
+        ERR("Failed to save thumbnail of \"" << thumbnail.levelName << "\".");
+
+        return;
+    }
+
+    file.write(thumbnailMagic, 4);
+    file.write((const char*) &thumbnailVersion, 4);
+    file.write((const char*) &thumbnail.width, 4);
+    file.write((const char*) &thumbnail.height, 4);
+    file.write((const char*) thumbnail.pixels.data(), (std::streamsize) thumbnail.pixels.size());
+}
+
+// Get the path of a level's thumbnail on disk.
+
+std::string ThumbnailCache::GetPath(unsigned long long levelHash) const
+{
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", levelHash);
+
+    return directory + "/" + name + ".thumb";
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include "core/video/sprite_sheet.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+extern class ThumbnailCache* pThumbnails;
+
+// Largest width or height of a thumbnail in pixels.
+
+constexpr int thumbnailSize = 64;
+
+// Minimap thumbnails of levels, keyed by the hash of their contents;
+// Thumbnails are read from disk or drawn on a worker thread, then uploaded on the main thread.
+
+class ThumbnailCache
+{
+public:
+    ThumbnailCache(std::string_view directory);
+    ~ThumbnailCache();
+
+    void Update();
+
+    bool GetThumbnail(std::string_view levelName, unsigned long long levelHash, SpriteSheet& outSheet);
+
+private:
+    struct Thumbnail
+    {
+        std::string levelName;
+        unsigned long long levelHash;
+
+        int width;
+        int height;
+        std::vector<unsigned char> pixels;
+    };
+
+    void Work();
+
+    bool LoadThumbnail(Thumbnail& thumbnail) const;
+    void SaveThumbnail(const Thumbnail& thumbnail) const;
+    std::string GetPath(unsigned long long levelHash) const;
+
+    std::string directory;
+
+    std::unordered_map<unsigned long long, SpriteSheet> sheets;
+
+    // Shared with the worker thread.
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    std::deque<Thumbnail> requests;
+    std::vector<Thumbnail> finished;
+    bool stopping;
+
+    std::thread worker;
+};
+
+#endif
\ No newline at end of file
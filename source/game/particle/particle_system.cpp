@@ -0,0 +1,270 @@
+#include "particle_system.h"
+#include "core/video/renderer.h"
+#include "core/maths/simd.h"
+#include "game/level/tile_collision.h"
+
+// Check if a leading edge moving by a step crosses into a new row or column of tiles.
+
+static bool CrossesTile(float edge, float step)
+{
+    return step > 0.0f ? ceilf(edge + step) != ceilf(edge) : floorf(edge + step) != floorf(edge);
+}
+
+// Initialise the particle system.
+
+ParticleSystem::ParticleSystem(float size, float restitution, float damping)
+    : size(size), restitution(restitution), damping(damping), sprite(), depth(0.0f)
+{}
+
+// Update all particles;
+// Moves, bounces off solid tiles, then damps their velocity.
+
+void ParticleSystem::Update(float delta)
+{
+    int count = GetCount();
+    int i = 0;
+
+    previousX = positionX;
+    previousY = positionY;
+
+#ifdef MATHS_SIMD
+
+    const float4 zero = Splat4(0.0f);
+    const float4 deltas = Splat4(delta);
+    const float4 half = Splat4(size * 0.5f);
+    const float4 epsilons = Splat4(epsilon);
+
+    // Move four particles at a time;
+    // Only particles whose leading edges enter new tiles are swept through the level.
+
+    for (; i + 4 <= count; i += 4)
+    {
+        float4 x = Load4(&positionX[i]);
+        float4 y = Load4(&positionY[i]);
+        float4 vx = Load4(&velocityX[i]);
+        float4 vy = Load4(&velocityY[i]);
+
+        // Particles with a nearly zero velocity are at rest.
+
+        float4 moving = (Abs4(vx) >= epsilons) | (Abs4(vy) >= epsilons);
+
+        float4 stepX = vx * deltas;
+        float4 stepY = vy * deltas;
+        float4 rightward = vx > zero;
+        float4 upward = vy > zero;
+        float4 edgeX = Select4(rightward, x + half, x - half);
+        float4 edgeY = Select4(upward, y + half, y - half);
+
+        float4 tileX = Select4(rightward, Ceil4(edgeX), Floor4(edgeX));
+        float4 tileY = Select4(upward, Ceil4(edgeY), Floor4(edgeY));
+        float4 movedX = Select4(rightward, Ceil4(edgeX + stepX), Floor4(edgeX + stepX));
+        float4 movedY = Select4(upward, Ceil4(edgeY + stepY), Floor4(edgeY + stepY));
+
+        float4 crossing = moving & ((tileX < movedX) | (tileX > movedX) | (tileY < movedY) | (tileY > movedY));
+        int lanes = Mask4(crossing);
+
+        // Move the particles that stay within their tiles.
+
+        Store4(&positionX[i], Select4(moving, x + stepX, x));
+        Store4(&positionY[i], Select4(moving, y + stepY, y));
+
+        // Sweep the others from where they started.
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (lanes & (1 << lane))
+            {
+                positionX[i + lane] = previousX[i + lane];
+                positionY[i + lane] = previousY[i + lane];
+
+                MoveParticle(i + lane, delta);
+            }
+        }
+    }
+
+#endif
+
+    for (; i < count; i++)
+    {
+        if (Abs(velocityX[i]) >= epsilon || Abs(velocityY[i]) >= epsilon)
+        {
+            float half = size * 0.5f;
+            float edgeX = positionX[i] + (velocityX[i] > 0.0f ? half : -half);
+            float edgeY = positionY[i] + (velocityY[i] > 0.0f ? half : -half);
+
+            if (CrossesTile(edgeX, velocityX[i] * delta) || CrossesTile(edgeY, velocityY[i] * delta))
+            {
+                MoveParticle(i, delta);
+            }
+            else
+            {
+                positionX[i] += velocityX[i] * delta;
+                positionY[i] += velocityY[i] * delta;
+            }
+        }
+    }
+
+    DampVelocities(velocityX.data(), velocityY.data(), count, delta * damping);
+}
+
+// Render all particles in a single batch.
+
+void ParticleSystem::Render(float alpha) const
+{
+    int count = GetCount();
+    float offset = size * -0.5f;
+
+    renderPositions.resize(count);
+
+    LerpPositions(previousX.data(), previousY.data(), positionX.data(), positionY.data(), count, alpha,
+                  vector2f(offset, offset), renderPositions.data());
+
+    pRenderer->DrawSprites(sprite, renderPositions.data(), count, depth, size, size);
+}
+
+// Emit a particle at a position with a velocity.
+
+void ParticleSystem::Emit(vector2f position, vector2f velocity)
+{
+    positionX.push_back(position.x);
+    positionY.push_back(position.y);
+    previousX.push_back(position.x);
+    previousY.push_back(position.y);
+    velocityX.push_back(velocity.x);
+    velocityY.push_back(velocity.y);
+}
+
+// Push away all particles within a radius of a position.
+
+void ParticleSystem::Push(vector2f position, float sqrRadius, float speed)
+{
+    for (int i = 0; i < GetCount(); i++)
+    {
+        vector2f offset(positionX[i] - position.x, positionY[i] - position.y);
+
+        if (offset.SqrLength() < sqrRadius)
+        {
+            vector2f velocity = offset.Normalised() * speed;
+
+            velocityX[i] = velocity.x;
+            velocityY[i] = velocity.y;
+        }
+    }
+}
+
+// Set the sprite and depth particles are drawn with.
+
+void ParticleSystem::SetSprite(const Sprite& sprite, float depth)
+{
+    this->sprite = sprite;
+    this->depth = depth;
+}
+
+// Remove every particle.
+
+void ParticleSystem::Clear()
+{
+    positionX.clear();
+    positionY.clear();
+    previousX.clear();
+    previousY.clear();
+    velocityX.clear();
+    velocityY.clear();
+}
+
+// Write every particle to a snapshot.
+
+void ParticleSystem::SaveState(SnapshotWriter& writer) const
+{
+    int count = GetCount();
+    writer.Write(count);
+
+    for (const std::vector<float>* pArray : {&positionX, &positionY, &previousX, &previousY, &velocityX, &velocityY})
+    {
+        writer.Write(pArray->data(), sizeof(float) * count);
+    }
+}
+
+// Replace every particle with those in a snapshot.
+
+void ParticleSystem::LoadState(SnapshotReader& reader)
+{
+    int count = Max(reader.Read<int>(), 0);
+
+    for (std::vector<float>* pArray : {&positionX, &positionY, &previousX, &previousY, &velocityX, &velocityY})
+    {
+        pArray->resize(reader.IsValid() ? count : 0);
+        reader.Read(pArray->data(), sizeof(float) * pArray->size());
+    }
+}
+
+// Check if any particle moving faster than a speed is near a position;
+// Both the distance and speed are squared.
+
+bool ParticleSystem::IsHitting(vector2f position, float sqrDistance, float sqrSpeed) const
+{
+    int count = GetCount();
+    int i = 0;
+
+#ifdef MATHS_SIMD
+
+    const float4 targetX = Splat4(position.x);
+    const float4 targetY = Splat4(position.y);
+    const float4 distances = Splat4(sqrDistance);
+    const float4 speeds = Splat4(sqrSpeed);
+
+    // Test four particles at a time.
+
+    for (; i + 4 <= count; i += 4)
+    {
+        float4 dx = Load4(&positionX[i]) - targetX;
+        float4 dy = Load4(&positionY[i]) - targetY;
+        float4 vx = Load4(&velocityX[i]);
+        float4 vy = Load4(&velocityY[i]);
+
+        float4 nearby = (dx * dx + dy * dy) < distances;
+        float4 fast = (vx * vx + vy * vy) > speeds;
+
+        if (Mask4(nearby & fast))
+        {
+            return true;
+        }
+    }
+
+#endif
+
+    for (; i < count; i++)
+    {
+        float dx = positionX[i] - position.x;
+        float dy = positionY[i] - position.y;
+
+        if (velocityX[i] * velocityX[i] + velocityY[i] * velocityY[i] > sqrSpeed && dx * dx + dy * dy < sqrDistance)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Get the number of particles.
+
+int ParticleSystem::GetCount() const
+{
+    return (int) positionX.size();
+}
+
+// Sweep a particle through the level's tiles.
+
+void ParticleSystem::MoveParticle(int index, float delta)
+{
+    vector2f position(positionX[index], positionY[index]);
+    vector2f velocity(velocityX[index], velocityY[index]);
+
+    MoveBox(position, velocity, vector2f(size, size) * 0.5f, restitution, delta);
+
+    positionX[index] = position.x;
+    positionY[index] = position.y;
+    velocityX[index] = velocity.x;
+    velocityY[index] = velocity.y;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include "core/minimal.h"
+#include "game/rewind/snapshot.h"
+#include <vector>
+
+// Particles stored as structure-of-arrays;
+// Updated, collided and drawn in batches rather than as entities.
+
+class ParticleSystem
+{
+public:
+    ParticleSystem(float size, float restitution, float damping);
+
+    void Update(float delta);
+    void Render(float alpha) const;
+
+    void Emit(vector2f position, vector2f velocity);
+    void Push(vector2f position, float sqrRadius, float speed);
+    void SetSprite(const Sprite& sprite, float depth);
+    void Clear();
+
+    void SaveState(SnapshotWriter& writer) const;
+    void LoadState(SnapshotReader& reader);
+
+    bool IsHitting(vector2f position, float sqrDistance, float sqrSpeed) const;
+    int GetCount() const;
+
+private:
+    void MoveParticle(int index, float delta);
+
+    float size;
+    float restitution;
+    float damping;
+
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> previousX;
+    std::vector<float> previousY;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+
+    mutable std::vector<vector2f> renderPositions;
+
+    Sprite sprite;
+    float depth;
+};
+
+#endif
\ No newline at end of file
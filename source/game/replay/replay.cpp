@@ -0,0 +1,348 @@
+#include "replay.h"
+#include "core/file/asset_pack.h"
+#include "core/hash.h"
+#include "core/input/controller.h"
+#include <filesystem>
+#include <fstream>
+
+// Buttons whose held state is recorded, in bit order.
+
+constexpr Button recordedButtons[] = {KEY_W, KEY_A, KEY_S, KEY_D, MOUSE_LEFT};
+constexpr int recordedCount = sizeof(recordedButtons) / sizeof(Button);
+
+// Input state bit flags;
+// The throw bit is set on the tick a left click is pressed.
+
+constexpr unsigned char throwBit = 1 << recordedCount;
+constexpr unsigned char mouseBit = 1 << 7;
+
+// Magic number at the start of replay files.
+
+constexpr char replayMagic[4] = {'M', 'O', 'D', 'R'};
+
+// Get the recorded input state of the controller.
+
+static unsigned char GetInputState(const Controller& controller)
+{
+    unsigned char state = 0;
+
+    for (int i = 0; i < recordedCount; i++)
+    {
+        state |= (unsigned char) (controller.IsHeldDown(recordedButtons[i]) << i);
+    }
+
+    if (controller.WasPressed(MOUSE_LEFT))
+    {
+        state |= throwBit;
+    }
+
+    return state;
+}
+
+// Initialise an empty replay.
+
+Replay::Replay()
+    : levelHash(0), version(simulationVersion), tickRate(0), chainDelay(0.0f),
+      tickCount(0), time(0.0), playbackRun(0), playbackTick(0)
+{}
+
+// Initialise a replay for recording a level.
+
+Replay::Replay(std::string_view levelName, unsigned long long levelHash, int tickRate, float chainDelay)
+    : levelName(levelName), levelHash(levelHash), version(simulationVersion), tickRate(tickRate),
+      chainDelay(chainDelay), tickCount(0), time(0.0), playbackRun(0), playbackTick(0)
+{}
+
+// Record the controller's input for one tick.
+
+void Replay::Record(const Controller& controller)
+{
+    unsigned char state = GetInputState(controller);
+    vector2f mousePosition = controller.GetMousePosition();
+
+    tickCount++;
+
+    // Extend the current run if the input is unchanged.
+
+    if (!runs.empty())
+    {
+        ReplayRun& run = runs.back();
+
+        if (run.state == state && run.mousePosition.x == mousePosition.x && run.mousePosition.y == mousePosition.y)
+        {
+            run.ticks++;
+
+            return;
+        }
+    }
+
+    runs.push_back({1, state, mousePosition});
+}
+
+// Apply the next tick of recorded input to a controller;
+// Returns false once all ticks have been played back.
+
+bool Replay::Playback(Controller& controller)
+{
+    if (playbackRun >= (int) runs.size())
+    {
+        return false;
+    }
+
+    const ReplayRun& run = runs[playbackRun];
+
+    // Press or release the buttons that differ from the recording.
+
+    for (int i = 0; i < recordedCount; i++)
+    {
+        Button button = recordedButtons[i];
+        bool held = run.state & (1 << i);
+
+        if (held != controller.IsHeldDown(button))
+        {
+            controller.OnButtonAction(button, held ? PRESS : RELEASE);
+        }
+    }
+
+    // Match the left click press, which may have been seen by a menu instead while recording.
+
+    bool throwing = run.state & throwBit;
+
+    if (throwing != controller.WasPressed(MOUSE_LEFT))
+    {
+        controller.SetPreviouslyHeld(MOUSE_LEFT, !throwing);
+    }
+
+    controller.OnMousePosition(run.mousePosition);
+
+    // Advance to the next tick.
+
+    if (++playbackTick >= run.ticks)
+    {
+        playbackTick = 0;
+        playbackRun++;
+    }
+
+    return true;
+}
+
+// Restart playback from the first tick.
+
+void Replay::Rewind()
+{
+    playbackRun = 0;
+    playbackTick = 0;
+}
+
+// Save the replay to a file.
+
+bool Replay::Save(std::string_view path) const
+{
+    std::filesystem::path directory(path);
+    std::filesystem::create_directories(directory.remove_filename());
+
+    std::ofstream file(path.data(), std::ios::binary);
+
+    if (!file.is_open())
+    {
+        ERR("Failed to save replay to \"" << path << "\".");
+
+        return false;
+    }
+
+    // Write the header.
+
+    int nameLength = (int) levelName.length();
+    int runCount = (int) runs.size();
+
+    file.write(replayMagic, 4);
+    file.write((char*) &version, 4);
+    file.write((char*) &tickRate, 4);
+    file.write((char*) &chainDelay, 4);
+    file.write((char*) &levelHash, 8);
+    file.write((char*) &time, 8);
+    file.write((char*) &tickCount, 4);
+    file.write((char*) &nameLength, 4);
+    file.write(levelName.c_str(), nameLength);
+    file.write((char*) &runCount, 4);
+
+    // Write each run as a variable-length tick count and a state byte;
+    // The mouse position is only written when it changes.
+
+    vector2f mousePosition;
+
+    for (const ReplayRun& run : runs)
+    {
+        unsigned int ticks = (unsigned int) run.ticks;
+
+        while (ticks >= 0x80)
+        {
+            file.put((char) ((ticks & 0x7F) | 0x80));
+            ticks >>= 7;
+        }
+
+        file.put((char) ticks);
+
+        bool moved = run.mousePosition.x != mousePosition.x || run.mousePosition.y != mousePosition.y;
+        file.put((char) (run.state | (moved ? mouseBit : 0)));
+
+        if (moved)
+        {
+            file.write((char*) &run.mousePosition.x, 4);
+            file.write((char*) &run.mousePosition.y, 4);
+
+            mousePosition = run.mousePosition;
+        }
+    }
+
+    LOG("Saved replay to \"" << path << "\".");
+
+    return true;
+}
+
+// Load the replay from a file.
+
+bool Replay::Load(std::string_view path)
+{
+    std::ifstream file(path.data(), std::ios::binary);
+
+    // Validate that the file was opened and is a replay.
+
+    char magic[4] = {};
+    file.read(magic, 4);
+
+    if (!file.is_open() || !std::equal(magic, magic + 4, replayMagic))
+    {
+        ERR("Failed to load replay from \"" << path << "\".");
+
+        return false;
+    }
+
+    // Read the header.
+
+    int nameLength = 0;
+    int runCount = 0;
+
+    file.read((char*) &version, 4);
+    file.read((char*) &tickRate, 4);
+    file.read((char*) &chainDelay, 4);
+    file.read((char*) &levelHash, 8);
+    file.read((char*) &time, 8);
+    file.read((char*) &tickCount, 4);
+    file.read((char*) &nameLength, 4);
+
+    levelName.resize(Max(nameLength, 0));
+    file.read(&levelName[0], (std::streamsize) levelName.length());
+    file.read((char*) &runCount, 4);
+
+    // Read the runs of input.
+
+    runs.clear();
+    runs.reserve(Max(runCount, 0));
+
+    vector2f mousePosition;
+
+    for (int i = 0; i < runCount && file; i++)
+    {
+        unsigned int ticks = 0;
+        int shift = 0;
+        int byte;
+
+        do
+        {
+            byte = file.get();
+            ticks |= (unsigned int) (byte & 0x7F) << shift;
+            shift += 7;
+        }
+        while ((byte & 0x80) && file);
+
+        unsigned char state = (unsigned char) file.get();
+
+        if (state & mouseBit)
+        {
+            file.read((char*) &mousePosition.x, 4);
+            file.read((char*) &mousePosition.y, 4);
+        }
+
+        runs.push_back({(int) ticks, (unsigned char) (state & ~mouseBit), mousePosition});
+    }
+
+    if (!file)
+    {
+        ERR("Replay \"" << path << "\" is truncated.");
+
+        return false;
+    }
+
+    Rewind();
+
+    LOG("Loaded replay from \"" << path << "\".");
+
+    return true;
+}
+
+// Set the completion time of the replay.
+
+void Replay::SetTime(double time)
+{
+    this->time = time;
+}
+
+// Get the name of the recorded level.
+
+std::string_view Replay::GetLevelName() const
+{
+    return levelName;
+}
+
+// Get the hash of the recorded level's file.
+
+unsigned long long Replay::GetLevelHash() const
+{
+    return levelHash;
+}
+
+// Get the simulation version the replay was recorded with.
+
+int Replay::GetVersion() const
+{
+    return version;
+}
+
+// Get the simulation tick rate the replay was recorded at.
+
+int Replay::GetTickRate() const
+{
+    return tickRate;
+}
+
+// Get the chain reaction delay the replay was recorded with.
+
+float Replay::GetChainDelay() const
+{
+    return chainDelay;
+}
+
+// Get the number of recorded ticks.
+
+int Replay::GetTickCount() const
+{
+    return tickCount;
+}
+
+// Get the recorded completion time.
+
+double Replay::GetTime() const
+{
+    return time;
+}
+
+// Hash the contents of a level's file.
+
+unsigned long long Replay::HashLevel(std::string_view name)
+{
+    Asset file;
+    file.Open("levels/" + std::string(name) + ".level");
+
+    return Hash(file.GetData(), file.GetSize());
+}
\ No newline at end of file
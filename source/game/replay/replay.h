@@ -0,0 +1,66 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "core/minimal.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Controller;
+
+// Version of the simulation replays are recorded against;
+// Increment whenever a change alters how recorded input plays back.
+
+constexpr int simulationVersion = 6;
+
+// A run of consecutive ticks with identical input.
+
+struct ReplayRun
+{
+    int ticks;
+    unsigned char state;
+    vector2f mousePosition;
+};
+
+class Replay
+{
+public:
+    Replay();
+    Replay(std::string_view levelName, unsigned long long levelHash, int tickRate, float chainDelay);
+
+    void Record(const Controller& controller);
+    bool Playback(Controller& controller);
+    void Rewind();
+
+    bool Save(std::string_view path) const;
+    bool Load(std::string_view path);
+
+    void SetTime(double time);
+
+    std::string_view GetLevelName() const;
+    unsigned long long GetLevelHash() const;
+    int GetVersion() const;
+    int GetTickRate() const;
+    float GetChainDelay() const;
+    int GetTickCount() const;
+    double GetTime() const;
+
+public:
+    static unsigned long long HashLevel(std::string_view name);
+
+private:
+    std::string levelName;
+    unsigned long long levelHash;
+    int version;
+    int tickRate;
+    float chainDelay;
+    int tickCount;
+    double time;
+
+    std::vector<ReplayRun> runs;
+
+    int playbackRun;
+    int playbackTick;
+};
+
+#endif
\ No newline at end of file
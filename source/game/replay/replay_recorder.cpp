@@ -0,0 +1,35 @@
+#include "replay_recorder.h"
+
+ReplayRecorder* pRecorder;
+
+// Initialise the replay recorder.
+
+ReplayRecorder::ReplayRecorder(int tickRate, float chainDelay)
+    : tickRate(tickRate), chainDelay(chainDelay)
+{
+    pRecorder = this;
+
+    LOG("Initialised the Replay Recorder.");
+}
+
+// Begin recording a new run of a level.
+
+void ReplayRecorder::Begin(std::string_view levelName, unsigned long long levelHash)
+{
+    replay = Replay(levelName, levelHash, tickRate, chainDelay);
+}
+
+// Record the input for one tick.
+
+void ReplayRecorder::Record(const Controller& controller)
+{
+    replay.Record(controller);
+}
+
+// Finish the run with a completion time and save it.
+
+void ReplayRecorder::Finish(double time)
+{
+    replay.SetTime(time);
+    replay.Save("replays/" + std::string(replay.GetLevelName()) + ".replay");
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef REPLAY_RECORDER_H
+#define REPLAY_RECORDER_H
+
+#include "replay.h"
+#include <string_view>
+
+extern class ReplayRecorder* pRecorder;
+
+class ReplayRecorder
+{
+public:
+    ReplayRecorder(int tickRate, float chainDelay);
+
+    void Begin(std::string_view levelName, unsigned long long levelHash);
+    void Record(const Controller& controller);
+    void Finish(double time);
+
+private:
+    int tickRate;
+    float chainDelay;
+
+    Replay replay;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "rewind_buffer.h"
+#include <cstring>
+
+// Append an unsigned integer using 7 bits per byte.
+
+static void WriteVarint(std::vector<unsigned char>& bytes, size_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back((unsigned char) (value | 0x80));
+        value >>= 7;
+    }
+
+    bytes.push_back((unsigned char) value);
+}
+
+// Read an unsigned integer written with WriteVarint.
+
+static size_t ReadVarint(const unsigned char*& pBytes)
+{
+    size_t value = 0;
+
+    for (int shift = 0; ; shift += 7)
+    {
+        unsigned char byte = *pBytes++;
+        value |= (size_t) (byte & 0x7F) << shift;
+
+        if (byte < 0x80)
+        {
+            return value;
+        }
+    }
+}
+
+// Encode the difference between two states;
+// Runs of unchanged bytes are skipped and changed bytes are stored XORed with the previous state.
+
+static void EncodeDelta(const std::vector<unsigned char>& previous, const std::vector<unsigned char>& current,
+                        std::vector<unsigned char>& outBytes)
+{
+    size_t size = current.size();
+    size_t overlap = previous.size() < size ? previous.size() : size;
+
+    auto difference = [&](size_t i) { return (unsigned char) (current[i] ^ (i < overlap ? previous[i] : 0)); };
+
+    WriteVarint(outBytes, size);
+
+    size_t i = 0;
+
+    while (i < size)
+    {
+        // Count the unchanged bytes, then the changed bytes up to the next pair of unchanged ones.
+
+        size_t skipStart = i;
+
+        while (i < size && difference(i) == 0)
+        {
+            i++;
+        }
+
+        size_t literalStart = i;
+
+        while (i < size && (difference(i) != 0 || (i + 1 < size && difference(i + 1) != 0)))
+        {
+            i++;
+        }
+
+        WriteVarint(outBytes, literalStart - skipStart);
+        WriteVarint(outBytes, i - literalStart);
+
+        for (size_t j = literalStart; j < i; j++)
+        {
+            outBytes.push_back(difference(j));
+        }
+    }
+}
+
+// Apply an encoded difference to a state, turning it into the next state.
+
+static void ApplyDelta(const unsigned char* pBytes, const unsigned char* pEnd, std::vector<unsigned char>& state)
+{
+    size_t previousSize = state.size();
+    size_t size = ReadVarint(pBytes);
+
+    // Bytes beyond the previous state are XORed with zero.
+
+    state.resize(size);
+
+    if (size > previousSize)
+    {
+        memset(state.data() + previousSize, 0, size - previousSize);
+    }
+
+    size_t i = 0;
+
+    while (pBytes < pEnd)
+    {
+        i += ReadVarint(pBytes);
+        size_t count = ReadVarint(pBytes);
+
+        for (size_t j = 0; j < count; j++)
+        {
+            state[i++] ^= *pBytes++;
+        }
+    }
+}
+
+// Initialise an empty buffer with a capacity in bytes.
+
+RewindBuffer::RewindBuffer(size_t capacity, int keyframeInterval)
+    : ring(capacity), head(0), usedBytes(0), keyframeInterval(keyframeInterval < 1 ? 1 : keyframeInterval),
+      sinceKeyframe(0)
+{}
+
+// Add a snapshot of state as the newest frame;
+// The oldest frames are dropped to make room.
+
+void RewindBuffer::Push(const std::vector<unsigned char>& state)
+{
+    bool keyframe = frames.empty() || sinceKeyframe >= keyframeInterval - 1 || previous.empty();
+
+    encoded.clear();
+
+    if (keyframe)
+    {
+        encoded.insert(encoded.end(), state.begin(), state.end());
+        sinceKeyframe = 0;
+    }
+    else
+    {
+        EncodeDelta(previous, state, encoded);
+        sinceKeyframe++;
+    }
+
+    // Later deltas are encoded against this state, unless it could not be stored.
+
+    if (Store(encoded, keyframe))
+    {
+        previous = state;
+    }
+    else
+    {
+        previous.clear();
+    }
+}
+
+// Remove the newest frame and rebuild the state it holds;
+// Deltas are applied forwards from the frame's keyframe.
+
+bool RewindBuffer::Pop(std::vector<unsigned char>& outState)
+{
+    if (frames.empty())
+    {
+        return false;
+    }
+
+    size_t first = frames.size() - 1;
+
+    while (!frames[first].keyframe)
+    {
+        first--;
+    }
+
+    const Frame& keyframe = frames[first];
+    outState.assign(&ring[keyframe.offset], &ring[keyframe.offset] + keyframe.size);
+
+    for (size_t i = first + 1; i < frames.size(); i++)
+    {
+        const unsigned char* pBytes = &ring[frames[i].offset];
+
+        ApplyDelta(pBytes, pBytes + frames[i].size, outState);
+    }
+
+    // Reclaim the frame's space and start the next push with a keyframe.
+
+    head = frames.back().offset;
+    usedBytes -= frames.back().size;
+    frames.pop_back();
+
+    previous.clear();
+
+    return true;
+}
+
+// Remove every frame.
+
+void RewindBuffer::Clear()
+{
+    frames.clear();
+    head = 0;
+    usedBytes = 0;
+    sinceKeyframe = 0;
+    previous.clear();
+}
+
+// Get the number of frames held.
+
+int RewindBuffer::GetFrameCount() const
+{
+    return (int) frames.size();
+}
+
+// Get the number of bytes used by the frames held.
+
+size_t RewindBuffer::GetUsedBytes() const
+{
+    return usedBytes;
+}
+
+// Copy an encoded frame into the ring after the newest one;
+// Overwritten frames are dropped, along with deltas whose keyframe was dropped.
+
+bool RewindBuffer::Store(const std::vector<unsigned char>& bytes, bool keyframe)
+{
+    size_t size = bytes.size();
+
+    if (size == 0 || size > ring.size())
+    {
+        Clear();
+
+        return false;
+    }
+
+    size_t offset = head;
+
+    // Wrap to the start when the frame does not fit before the end;
+    // Frames between the head and the end are the oldest, so they are dropped first.
+
+    if (offset + size > ring.size())
+    {
+        while (!frames.empty() && frames.front().offset >= head)
+        {
+            usedBytes -= frames.front().size;
+            frames.pop_front();
+        }
+
+        offset = 0;
+    }
+
+    auto overlaps = [&](const Frame& frame) { return frame.offset < offset + size && offset < frame.offset + frame.size; };
+
+    while (!frames.empty() && (overlaps(frames.front()) || !frames.front().keyframe))
+    {
+        usedBytes -= frames.front().size;
+        frames.pop_front();
+    }
+
+    // A delta cannot be kept once its keyframe is gone.
+
+    if (frames.empty() && !keyframe)
+    {
+        return false;
+    }
+
+    memcpy(&ring[offset], bytes.data(), size);
+
+    frames.push_back({offset, size, keyframe});
+    head = offset + size;
+    usedBytes += size;
+
+    return true;
+}
\ No newline at end of file
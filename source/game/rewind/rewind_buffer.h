@@ -0,0 +1,45 @@
+#ifndef REWIND_BUFFER_H
+#define REWIND_BUFFER_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// History of state snapshots kept in a fixed-size ring of bytes;
+// A full keyframe is stored every few snapshots and XOR deltas, run-length encoded, in between.
+
+class RewindBuffer
+{
+public:
+    RewindBuffer(size_t capacity, int keyframeInterval);
+
+    void Push(const std::vector<unsigned char>& state);
+    bool Pop(std::vector<unsigned char>& outState);
+    void Clear();
+
+    int GetFrameCount() const;
+    size_t GetUsedBytes() const;
+
+private:
+    struct Frame
+    {
+        size_t offset;
+        size_t size;
+        bool keyframe;
+    };
+
+    bool Store(const std::vector<unsigned char>& bytes, bool keyframe);
+
+    std::vector<unsigned char> ring;
+    std::deque<Frame> frames;
+    size_t head;
+    size_t usedBytes;
+
+    int keyframeInterval;
+    int sinceKeyframe;
+
+    std::vector<unsigned char> previous;
+    std::vector<unsigned char> encoded;
+};
+
+#endif
\ No newline at end of file
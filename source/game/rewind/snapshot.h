@@ -0,0 +1,101 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Appends plain values to a snapshot of state.
+
+class SnapshotWriter
+{
+public:
+    SnapshotWriter(std::vector<unsigned char>& bytes)
+        : bytes(bytes)
+    {}
+
+    // Write a block of bytes.
+
+    void Write(const void* pData, size_t size)
+    {
+        size_t offset = bytes.size();
+
+        bytes.resize(offset + size);
+
+        if (size > 0)
+        {
+            memcpy(&bytes[offset], pData, size);
+        }
+    }
+
+    // Write a plain value.
+
+    template<typename T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value);
+
+        Write(&value, sizeof(T));
+    }
+
+private:
+    std::vector<unsigned char>& bytes;
+};
+
+// Reads plain values back from a snapshot of state;
+// Reading past the end gives zeroes and marks the reader as failed.
+
+class SnapshotReader
+{
+public:
+    SnapshotReader(const std::vector<unsigned char>& bytes)
+        : bytes(bytes), offset(0), failed(false)
+    {}
+
+    // Read a block of bytes.
+
+    void Read(void* pData, size_t size)
+    {
+        if (failed || size > bytes.size() - offset)
+        {
+            memset(pData, 0, size);
+            failed = true;
+
+            return;
+        }
+
+        if (size > 0)
+        {
+            memcpy(pData, &bytes[offset], size);
+        }
+
+        offset += size;
+    }
+
+    // Read a plain value.
+
+    template<typename T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value);
+
+        T value;
+        Read(&value, sizeof(T));
+
+        return value;
+    }
+
+    // Check if every read so far was within the snapshot.
+
+    bool IsValid() const
+    {
+        return !failed;
+    }
+
+private:
+    const std::vector<unsigned char>& bytes;
+    size_t offset;
+    bool failed;
+};
+
+#endif
\ No newline at end of file
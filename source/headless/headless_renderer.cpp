@@ -0,0 +1,71 @@
+#include "core/video/renderer.h"
+#include "core/logging.h"
+
+// Headless implementation of the renderer;
+// Nothing is drawn and sprite sheets are not loaded.
+
+Renderer* pRenderer;
+
+// Initialise the renderer.
+
+Renderer::Renderer(std::string_view vertexPath, std::string_view fragmentPath)
+    : shaderProgram(0), vertexArray(0), vertexBuffer(0), indexBuffer(0), instanceBuffer(0),
+      projectionUniform(-1), positionUniform(-1), scaleUniform(-1), coordsUniform(-1), fontSprites()
+{
+    pRenderer = this;
+
+    LOG("Initialised the headless Renderer.");
+}
+
+// Terminate the renderer.
+
+Renderer::~Renderer() = default;
+
+// Set the sheet used for drawing strings.
+
+void Renderer::SetFontSheet(const SpriteSheet& sheet)
+{}
+
+// Set the rendering viewport resolution.
+
+void Renderer::SetResolution(int width, int height) const
+{}
+
+// Set an orthographic projection matrix.
+
+void Renderer::SetProjection(float l, float r, float b, float t, float depth) const
+{}
+
+// Draw a sprite at a position with a size.
+
+void Renderer::DrawSprite(const Sprite& sprite, float x, float y, float z, float w, float h) const
+{}
+
+// Draw a sprite at many positions.
+
+void Renderer::DrawSprites(const Sprite& sprite, const vector2f* pPositions, int count, float z, float w, float h) const
+{}
+
+// Draw a string at a position with an alignment.
+
+void Renderer::DrawString(std::string_view string, float x, float y, float z, float alignment) const
+{}
+
+// Clear the rendering viewport.
+
+void Renderer::Clear() const
+{}
+
+// Get a placeholder sprite sheet.
+
+SpriteSheet Renderer::GetSheet(std::string_view path, const Image* pImage)
+{
+    return {0, 1, 1};
+}
+
+// Get a placeholder sprite sheet with the given size.
+
+SpriteSheet Renderer::CreateSheet(const unsigned char* pPixels, int width, int height)
+{
+    return {0, width, height};
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "core/audio/sound_mixer.h"
+#include "core/logging.h"
+#include "miniaudio.h"
+#include <algorithm>
+
+// Headless implementation of the sound mixer;
+// Sounds are given identifiers but never loaded or played.
+
+SoundMixer* pSoundMixer;
+
+// Initialise the sound mixer.
+
+SoundMixer::SoundMixer(int sampleRate, int periodSize, int periodCount)
+    : pMusic(nullptr, nullptr), masterVolume(1.0f), pVoices(nullptr, nullptr), bufferLatency(0.0), lastCallbackTime(0),
+      totalWaitTime(0), waitCount(0), underrunCount(0),
+      callbackCount(0), totalMixTime(0), totalBufferTime(0), peakLoad(0.0f), overrunCount(0), activeVoiceCount(0),
+      peakVoiceCount(0), droppedCount(0), offline(false), pendingFrames(0.0), mixTime(0.0), mixedFrames(0),
+      soundCount(0), playCount(0), time(0.0)
+{
+    pSoundMixer = this;
+
+    LOG("Initialised the headless Sound Mixer.");
+}
+
+// Terminate the sound mixer.
+
+SoundMixer::~SoundMixer() = default;
+
+// Play the sounds queued during a tick.
+
+void SoundMixer::Update(float delta)
+{}
+
+// Set the master volume multiplier.
+
+void SoundMixer::SetMasterVolume(float volume)
+{}
+
+// Play a specified sound.
+
+void SoundMixer::PlaySound(const Sound& sound)
+{}
+
+// Stream a track as music.
+
+void SoundMixer::PlayMusic(std::string_view path)
+{}
+
+// Get a sound from file path.
+
+Sound SoundMixer::GetSound(std::string_view path, int voiceCount, int priority, float cooldown)
+{
+    auto location = std::find(files.begin(), files.end(), path);
+
+    if (location != files.end())
+    {
+        return {(int) (location - files.begin())};
+    }
+
+    files.emplace_back(path);
+
+    return {(int) files.size() - 1};
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "core/video/window.h"
+#include "core/logging.h"
+
+// Headless implementation of the window;
+// Reports a fixed size and never closes on its own.
+
+Window* pWindow;
+
+// Initialise the window.
+
+Window::Window(int width, int height, std::string_view title)
+    : data{nullptr, nullptr, nullptr, nullptr, width, height, width, height, false}, pNativeWindow(nullptr)
+{
+    pWindow = this;
+
+    LOG("Initialised the headless Window.");
+}
+
+// Terminate the window.
+
+Window::~Window() = default;
+
+// Swap buffers and poll events.
+
+void Window::Update()
+{}
+
+// Set a callback for keyboard input.
+
+void Window::SetKeyboardKeyCallback(std::function<void(int button, int action)> pCallback)
+{
+    data.pOnKeyboardKey = std::move(pCallback);
+}
+
+// Set a callback for mouse input.
+
+void Window::SetMouseButtonCallback(std::function<void(int button, int action)> pCallback)
+{
+    data.pOnMouseButton = std::move(pCallback);
+}
+
+// Set a callback for mouse position.
+
+void Window::SetMousePositionCallback(std::function<void(int x, int y)> pCallback)
+{
+    data.pOnMousePosition = std::move(pCallback);
+}
+
+// Set a callback for window resizing.
+
+void Window::SetResizeCallback(std::function<void(int width, int height)> pCallback)
+{
+    data.pOnResizeWindow = std::move(pCallback);
+}
+
+// Toggle the window's fullscreen mode.
+
+void Window::ToggleFullscreen()
+{
+    data.fullscreen = !data.fullscreen;
+}
+
+// Close the window.
+
+void Window::Close()
+{}
+
+// Get the window's desired width.
+
+int Window::GetDesiredWidth() const
+{
+    return data.desiredWidth;
+}
+
+// Get the window's desired height.
+
+int Window::GetDesiredHeight() const
+{
+    return data.desiredHeight;
+}
+
+// Get the window's width.
+
+int Window::GetWidth() const
+{
+    return data.width;
+}
+
+// Get the window's height.
+
+int Window::GetHeight() const
+{
+    return data.height;
+}
+
+// Check if the window is fullscreen.
+
+bool Window::IsFullscreen() const
+{
+    return data.fullscreen;
+}
+
+// Check if the window is open.
+
+bool Window::IsOpen() const
+{
+    return true;
+}
\ No newline at end of file
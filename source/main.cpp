@@ -1,4 +1,5 @@
 #include "core/audio/sound_mixer.h"
+#include "core/file/asset_pack.h"
 #include "core/input/controller.h"
 #include "core/video/renderer.h"
 #include "core/video/window.h"
@@ -6,11 +7,30 @@
 #include "game/config/configuration.h"
 #include "game/entity/player.h"
 #include "game/level/level.h"
+#include "game/level/level_index.h"
 #include "game/menu/main_menu.h"
+#include "game/menu/thumbnail_cache.h"
+#include "game/replay/replay_recorder.h"
 #include "game/save/save_slot.h"
 #include <chrono>
+#include <iomanip>
+#include <sstream>
 
-// Button action callback.
+using Clock = std::chrono::high_resolution_clock;
+
+// Time the game started, which input events and ticks are timed from.
+
+static const Clock::time_point startTime = Clock::now();
+
+// Get the seconds since the game started at a point in time.
+
+static double GetGameTime(Clock::time_point time)
+{
+    return std::chrono::duration<double>(time - startTime).count();
+}
+
+// Button action callback;
+// Input is stamped with when it was received, and applied by the tick it falls within.
 
 static void OnButton(int button, int action)
 {
@@ -19,7 +39,7 @@ static void OnButton(int button, int action)
         pWindow->ToggleFullscreen();
     }
 
-    pController->OnButtonAction((Button) button, (Action) action);
+    pController->QueueButtonAction((Button) button, (Action) action, GetGameTime(Clock::now()));
 }
 
 // Mouse move callback.
@@ -32,7 +52,7 @@ static void OnMouse(int x, int y)
     position.x = ((float) x - (float) pWindow->GetWidth() / 2.0f) / unitScale;
     position.y = ((float) pWindow->GetHeight() / 2.0f - (float) y) / unitScale;
 
-    pController->OnMousePosition(position);
+    pController->QueueMousePosition(position, GetGameTime(Clock::now()));
 }
 
 // Window resize callback.
@@ -42,6 +62,25 @@ static void OnResize(int width, int height)
     pRenderer->SetResolution(width, height);
 }
 
+// Draw the audio mixer's health in the corner of the screen.
+
+static void DrawAudioHealth(const AudioHealth& health)
+{
+    std::ostringstream text;
+
+    text << std::fixed << std::setprecision(2)
+         << "Mix " << health.mixTime * 1000.0 << "/" << health.bufferTime * 1000.0 << "ms"
+         << " (peak " << (int) (health.peakLoad * 100.0) << "%)\n"
+         << "Voices " << health.activeVoices << " (peak " << health.peakVoices << ")\n"
+         << "Underruns " << health.underruns << ", overruns " << health.overruns << "\n"
+         << "Latency " << (int) (health.outputLatency * 1000.0) << "ms";
+
+    vector2f bounds = pCamera->GetBounds();
+
+    pCamera->ApplyScreenProjection();
+    pRenderer->DrawString(text.str(), 0.25f - bounds.x, bounds.y - 0.25f, 4.0f, 0.0f);
+}
+
 // Program entry point.
 
 int main()
@@ -53,6 +92,9 @@ int main()
 
     // Initialise the core (engine) subsystems.
 
+    AssetPack assetPack("assets.pack");
+    LevelIndex levelIndex("cache/levels.index");
+
     Window window(config.windowWidth, config.windowHeight, "Man of Destruction");
     window.SetKeyboardKeyCallback(OnButton);
     window.SetMouseButtonCallback(OnButton);
@@ -63,7 +105,9 @@ int main()
     renderer.SetResolution(window.GetWidth(), window.GetHeight());
     renderer.SetFontSheet(renderer.GetSheet("assets/sprites/widget/font.bmp"));
 
-    SoundMixer soundMixer;
+    ThumbnailCache thumbnails("cache/thumbnails");
+
+    SoundMixer soundMixer(config.sampleRate, config.periodSize, config.periodCount);
     soundMixer.SetMasterVolume(config.masterVolume);
 
     Controller controller;
@@ -72,6 +116,10 @@ int main()
     camera.SetUnitScale(config.pixelScale * 16);
     camera.SetShakeStrength(config.cameraShake);
 
+    Level::SetChainDelay(config.chainDelay);
+    Level::SetRewindMemory(config.rewindMemory);
+    ReplayRecorder recorder(config.tickRate, config.chainDelay);
+
     // Set fullscreen mode based on config.
 
     if (config.fullscreen)
@@ -85,18 +133,22 @@ int main()
 
     Menu::Open<MainMenu>();
 
-    auto lastTime = std::chrono::high_resolution_clock::now();
+    const float tickDelta = 1.0f / (float) config.tickRate;
+    float accumulator = 0.0f;
+
+    auto lastTime = Clock::now();
 
     while (window.IsOpen())
     {
-        auto currentTime = std::chrono::high_resolution_clock::now();
+        auto currentTime = Clock::now();
         float delta = std::chrono::duration<float>(currentTime - lastTime).count();
 
         // Calculate the delta time (time between the previous and current frame);
-        // Below 40 fps, the game will slow down to retain accurate physics.
+        // Long stalls are capped so the simulation does not spiral trying to catch up.
 
-        delta = Min(delta, 0.025f);
+        delta = Min(delta, 0.25f);
         lastTime = currentTime;
+        accumulator += delta;
 
 #if _DEBUG
         std::string_view metric = pLevel ? "loop_level" : "loop_menu";
@@ -104,26 +156,41 @@ int main()
 
         START_METRIC(metric);
 
-        // Update the game's logic.
+        // Update the game's logic in fixed ticks, independent of the frame rate;
+        // The ticks cover the time accumulated up to now, and each applies the input received before it ends.
 
-        camera.Update(delta);
+        double frameTime = GetGameTime(currentTime);
 
-        if (pMenu)
-        {
-            pMenu->Update(delta);
-        }
-        else if (pLevel)
+        while (accumulator >= tickDelta)
         {
-            pLevel->Update(delta);
+            controller.ProcessEvents(frameTime - (double) accumulator + (double) tickDelta);
+            camera.Update(tickDelta);
+
+            if (pMenu)
+            {
+                pMenu->Update(tickDelta);
+            }
+            else if (pLevel)
+            {
+                pLevel->Update(tickDelta);
+            }
+
+            soundMixer.Update(tickDelta);
+            controller.Update();
+
+            accumulator -= tickDelta;
         }
 
-        // Render the game's graphics.
+        // Render the game's graphics, interpolated between the last two ticks.
+
+        float alpha = accumulator / tickDelta;
 
         renderer.Clear();
+        camera.SetInterpolation(alpha);
 
         if (pLevel)
         {
-            pLevel->Render();
+            pLevel->Render(alpha);
         }
 
         if (pMenu)
@@ -131,6 +198,11 @@ int main()
             pMenu->Render();
         }
 
+        if (config.audioStats)
+        {
+            DrawAudioHealth(soundMixer.GetHealth());
+        }
+
         STOP_METRIC(metric);
 
         window.Update();
@@ -142,6 +214,12 @@ int main()
     config.windowHeight = window.GetDesiredHeight();
     config.fullscreen = window.IsFullscreen();
 
+    // Release the cached levels before the subsystems they use are destroyed;
+    // This also waits for the next level's prefetch, which reads from the asset pack.
+
+    LevelTemplate::ClearCache();
+
+    soundMixer.RecordMetrics();
     SAVE_METRICS("metrics.txt");
 
     return 0;
@@ -0,0 +1,82 @@
+#include "core/file/asset_pack.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Directories whose files are packed, relative to the game's directory.
+
+constexpr const char* packedDirectories[] = {"assets", "levels"};
+
+// Program entry point;
+// Usage: AssetPacker [output path]
+
+int main(int argc, char** argv)
+{
+    std::string outputPath = argc > 1 ? argv[1] : "assets.pack";
+
+    if (outputPath.substr(0, 2) == "--")
+    {
+        std::cout << "Usage: AssetPacker [output path]" << std::endl;
+
+        return 2;
+    }
+
+    // Find every file in the packed directories, stored with forward slashes.
+
+    std::vector<std::string> paths;
+    size_t totalSize = 0;
+
+    for (const char* directory : packedDirectories)
+    {
+        std::error_code error;
+
+        for (const auto& file : std::filesystem::recursive_directory_iterator(directory, error))
+        {
+            if (file.is_regular_file())
+            {
+                paths.push_back(file.path().generic_string());
+                totalSize += (size_t) file.file_size();
+            }
+        }
+    }
+
+    std::sort(paths.begin(), paths.end());
+
+    if (paths.empty())
+    {
+        std::cout << "No assets found, run from the game's directory." << std::endl;
+
+        return 1;
+    }
+
+    if (!SaveAssetPack(outputPath, paths))
+    {
+        std::cout << "Failed to write \"" << outputPath << "\"." << std::endl;
+
+        return 1;
+    }
+
+    // Check that every asset can be found in the written pack.
+
+    AssetPack pack(outputPath);
+    int missing = 0;
+
+    for (const std::string& path : paths)
+    {
+        const unsigned char* pData;
+        size_t size;
+
+        if (!pack.Find(path, pData, size) || size != std::filesystem::file_size(path))
+        {
+            std::cout << "Missing or mismatched \"" << path << "\"." << std::endl;
+            missing++;
+        }
+    }
+
+    std::cout << "Packed " << paths.size() << " files (" << totalSize << " bytes) into \"" << outputPath << "\" ("
+              << std::filesystem::file_size(outputPath) << " bytes)." << std::endl;
+
+    return missing > 0 ? 1 : 0;
+}
\ No newline at end of file
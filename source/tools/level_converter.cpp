@@ -0,0 +1,121 @@
+#include "game/level/level_file.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Check that two levels have identical contents.
+
+static bool IsSameLevel(const LevelFile& first, const LevelFile& second)
+{
+    auto isSameTile = [](const Tile& a, const Tile& b) { return a.type == b.type && a.variant == b.variant; };
+    auto isSamePosition = [](const vector2f& a, const vector2f& b) { return a.x == b.x && a.y == b.y; };
+
+    return first.biome == second.biome && first.width == second.width && first.height == second.height
+        && isSamePosition(first.start, second.start) && isSamePosition(first.finish, second.finish)
+        && std::equal(first.dynamites.begin(), first.dynamites.end(), second.dynamites.begin(),
+                      second.dynamites.end(), isSamePosition)
+        && std::equal(first.tiles.begin(), first.tiles.end(), second.tiles.begin(), second.tiles.end(), isSameTile);
+}
+
+// Load a level and measure how long it took in milliseconds.
+
+static double TimeLoad(const std::string& path, LevelFile& outLevel)
+{
+    auto startTime = Clock::now();
+    LoadLevelFile(path, outLevel);
+
+    return std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+}
+
+// Program entry point;
+// Usage: LevelConverter [--rle] [level names...]
+
+int main(int argc, char** argv)
+{
+    bool compress = false;
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view argument = argv[i];
+
+        if (argument == "--rle")
+        {
+            compress = true;
+        }
+        else if (argument.substr(0, 2) == "--")
+        {
+            std::cout << "Usage: LevelConverter [--rle] [level names...]" << std::endl;
+
+            return 2;
+        }
+        else
+        {
+            names.emplace_back(argument);
+        }
+    }
+
+    // Convert every level if none were named.
+
+    if (names.empty())
+    {
+        for (const auto& file : std::filesystem::directory_iterator("levels"))
+        {
+            if (file.path().extension() == ".level")
+            {
+                names.push_back(file.path().stem().string());
+            }
+        }
+
+        std::sort(names.begin(), names.end());
+    }
+
+    int failures = 0;
+
+    for (const std::string& name : names)
+    {
+        std::string path = "levels/" + name + ".level";
+        LevelFile level = {};
+
+        double oldLoadTime = TimeLoad(path, level);
+        auto oldSize = std::filesystem::exists(path) ? std::filesystem::file_size(path) : 0;
+
+        if (level.tiles.empty())
+        {
+            std::cout << name << ": unreadable level" << std::endl;
+            failures++;
+
+            continue;
+        }
+
+        // Rewrite the level, then check that it loads back the same.
+
+        LevelFile converted = {};
+
+        if (!SaveLevelFile(path, level, compress))
+        {
+            std::cout << name << ": failed to save" << std::endl;
+            failures++;
+
+            continue;
+        }
+
+        double newLoadTime = TimeLoad(path, converted);
+        bool same = IsSameLevel(level, converted);
+
+        std::cout << name << ": " << oldSize << " -> " << std::filesystem::file_size(path) << " bytes, load "
+                  << oldLoadTime << "ms -> " << newLoadTime << "ms" << (same ? "" : " [MISMATCH]") << std::endl;
+
+        if (!same)
+        {
+            failures++;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,624 @@
+#include "core/hash.h"
+#include "game/level/level_file.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// The solver searches an abstraction of a level where the player walks freely within the
+// region of passable tiles around them and each action throws one stick of dynamite onto a
+// tile of that region. A state is (region, dynamite carried, broken tiles, collected pick-ups),
+// packed into 64-bit words; pick-ups inside the region are collected greedily.
+
+using StateKey = std::vector<unsigned long long>;
+
+constexpr int maxDynamite = 3;
+constexpr int shardCount = 64;
+
+// Hash a state key.
+
+struct StateKeyHash
+{
+    size_t operator()(const StateKey& key) const
+    {
+        return (size_t) Hash(key.data(), key.size() * sizeof(unsigned long long));
+    }
+};
+
+// A searched state and the throw that led to it.
+
+struct SolverNode
+{
+    StateKey key;
+    int parent;
+    int target;
+};
+
+// Discrete view of a level for the solver.
+
+struct SolverLevel
+{
+    int width;
+    int height;
+    int startCell;
+    int finishCell;
+
+    std::vector<int> types;
+    std::vector<int> breakIndices;
+    std::vector<int> pickupCells;
+
+    int brokenWords;
+    int pickupWords;
+};
+
+// Result of solving a level.
+
+struct SolverResult
+{
+    bool solvable;
+    bool exhausted;
+    int dynamiteUsed;
+    int statesSearched;
+    std::vector<int> route;
+};
+
+// State table shared by all threads, split into locked shards.
+
+class TranspositionTable
+{
+public:
+    // Insert a state; returns its identifier, or -1 if it was already present.
+
+    int Insert(const StateKey& key, int parent, int target)
+    {
+        int index = (int) (StateKeyHash()(key) % shardCount);
+        Shard& shard = shards[index];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        int identifier = (int) shard.nodes.size() * shardCount + index;
+
+        if (!shard.identifiers.emplace(key, identifier).second)
+        {
+            return -1;
+        }
+
+        shard.nodes.push_back({key, parent, target});
+        count++;
+
+        return identifier;
+    }
+
+    // Get a copy of a state by its identifier.
+
+    SolverNode Get(int identifier)
+    {
+        Shard& shard = shards[identifier % shardCount];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        return shard.nodes[identifier / shardCount];
+    }
+
+    // Get the number of states in the table.
+
+    int GetCount() const
+    {
+        return count;
+    }
+
+private:
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<StateKey, int, StateKeyHash> identifiers;
+        std::deque<SolverNode> nodes;
+    };
+
+    Shard shards[shardCount];
+    std::atomic<int> count = 0;
+};
+
+// Double-ended work queue owned by one thread;
+// The owner pops from the back while other threads steal from the front.
+
+class WorkQueue
+{
+public:
+    void Push(int item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(item);
+    }
+
+    bool Pop(int& outItem)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (items.empty())
+        {
+            return false;
+        }
+
+        outItem = items.back();
+        items.pop_back();
+
+        return true;
+    }
+
+    bool Steal(int& outItem)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (items.empty())
+        {
+            return false;
+        }
+
+        outItem = items.front();
+        items.pop_front();
+
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::deque<int> items;
+};
+
+// Bit helpers for state keys.
+
+static bool GetBit(const StateKey& key, int offset, int bit)
+{
+    return (key[offset + bit / 64] >> (bit % 64)) & 1ull;
+}
+
+static void SetBit(StateKey& key, int offset, int bit)
+{
+    key[offset + bit / 64] |= 1ull << (bit % 64);
+}
+
+// The last word of a key holds the dynamite carried and the region's lowest cell.
+
+static int GetDynamite(const StateKey& key)
+{
+    return (int) (key.back() & 0xFF);
+}
+
+static int GetRegionCell(const StateKey& key)
+{
+    return (int) (key.back() >> 8);
+}
+
+static void SetRegion(StateKey& key, int dynamite, int cell)
+{
+    key.back() = (unsigned long long) dynamite | (unsigned long long) cell << 8;
+}
+
+// Build the solver's view of a level file.
+
+static SolverLevel CreateSolverLevel(const LevelFile& file)
+{
+    SolverLevel level = {file.width, file.height};
+
+    level.startCell = (int) file.start.y * file.width + (int) file.start.x;
+    level.finishCell = (int) file.finish.y * file.width + (int) file.finish.x;
+
+    int breakableCount = 0;
+
+    for (const Tile& tile : file.tiles)
+    {
+        bool breakable = tile.type >= 1 && tile.type <= 3;
+
+        level.types.push_back(tile.type);
+        level.breakIndices.push_back(breakable ? breakableCount++ : -1);
+    }
+
+    for (const vector2f& position : file.dynamites)
+    {
+        level.pickupCells.push_back((int) position.y * file.width + (int) position.x);
+    }
+
+    level.brokenWords = (breakableCount + 63) / 64;
+    level.pickupWords = ((int) level.pickupCells.size() + 63) / 64;
+
+    return level;
+}
+
+// Check if the player can walk through a cell.
+
+static bool IsPassable(const SolverLevel& level, const StateKey& key, int cell)
+{
+    int type = level.types[cell];
+    int breakIndex = level.breakIndices[cell];
+
+    return type == 0 || (breakIndex != -1 && GetBit(key, 0, breakIndex));
+}
+
+// Flood fill the region reachable from the state's region cell.
+
+static void FillRegion(const SolverLevel& level, const StateKey& key, std::vector<int>& outRegion)
+{
+    std::vector<bool> visited(level.types.size(), false);
+
+    outRegion.clear();
+    outRegion.push_back(GetRegionCell(key));
+    visited[GetRegionCell(key)] = true;
+
+    for (int i = 0; i < (int) outRegion.size(); i++)
+    {
+        int cell = outRegion[i];
+        int x = cell % level.width;
+        int y = cell / level.width;
+
+        const int neighbours[4][2] = {{x + 1, y}, {x - 1, y}, {x, y + 1}, {x, y - 1}};
+
+        for (const auto& neighbour : neighbours)
+        {
+            if (neighbour[0] < 0 || neighbour[1] < 0 || neighbour[0] >= level.width || neighbour[1] >= level.height)
+            {
+                continue;
+            }
+
+            int next = neighbour[1] * level.width + neighbour[0];
+
+            if (!visited[next] && IsPassable(level, key, next))
+            {
+                visited[next] = true;
+                outRegion.push_back(next);
+            }
+        }
+    }
+}
+
+// Collect pick-ups in the region and point the key at the region's lowest cell;
+// Returns true if the finish is inside the region.
+
+static bool NormaliseState(const SolverLevel& level, StateKey& key, std::vector<int>& outRegion)
+{
+    FillRegion(level, key, outRegion);
+
+    int dynamite = GetDynamite(key);
+    int lowestCell = outRegion[0];
+    bool finished = false;
+
+    std::vector<bool> inRegion(level.types.size(), false);
+
+    for (int cell : outRegion)
+    {
+        inRegion[cell] = true;
+        lowestCell = Min(lowestCell, cell);
+        finished |= (cell == level.finishCell);
+    }
+
+    for (int i = 0; i < (int) level.pickupCells.size() && dynamite < maxDynamite; i++)
+    {
+        if (inRegion[level.pickupCells[i]] && !GetBit(key, level.brokenWords, i))
+        {
+            SetBit(key, level.brokenWords, i);
+            dynamite++;
+        }
+    }
+
+    SetRegion(key, dynamite, lowestCell);
+
+    return finished;
+}
+
+// Explode dynamite on a cell, chaining through dynamite tiles;
+// Returns false if nothing new breaks or the player has nowhere safe to stand.
+
+static bool ExplodeCell(const SolverLevel& level, const std::vector<int>& region, int target, StateKey& key)
+{
+    std::vector<int> explosions = {target};
+    bool brokeAny = false;
+
+    for (int i = 0; i < (int) explosions.size(); i++)
+    {
+        int x = explosions[i] % level.width;
+        int y = explosions[i] / level.width;
+
+        for (int ty = y - 1; ty <= y + 1; ty++)
+        {
+            for (int tx = x - 1; tx <= x + 1; tx++)
+            {
+                if ((tx == x && ty == y) || tx < 0 || ty < 0 || tx >= level.width || ty >= level.height)
+                {
+                    continue;
+                }
+
+                int cell = ty * level.width + tx;
+                int breakIndex = level.breakIndices[cell];
+
+                if (breakIndex != -1 && !GetBit(key, 0, breakIndex))
+                {
+                    SetBit(key, 0, breakIndex);
+                    brokeAny = true;
+
+                    if (level.types[cell] == 3)
+                    {
+                        explosions.push_back(cell);
+                    }
+                }
+            }
+        }
+    }
+
+    if (!brokeAny)
+    {
+        return false;
+    }
+
+    // The player must be able to stand out of range (2 tiles) of every explosion.
+
+    for (int cell : region)
+    {
+        bool safe = true;
+
+        for (int explosion : explosions)
+        {
+            float dx = (float) (cell % level.width - explosion % level.width);
+            float dy = (float) (cell / level.width - explosion / level.width);
+
+            safe &= (dx * dx + dy * dy >= 4.0f);
+        }
+
+        if (safe)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Expand one state into the states reachable by throwing a single dynamite.
+
+static void ExpandState(const SolverLevel& level, TranspositionTable& table, int identifier,
+                        std::vector<int>& outNext, std::atomic<int>& outGoal)
+{
+    SolverNode node = table.Get(identifier);
+    int dynamite = GetDynamite(node.key);
+
+    if (dynamite == 0)
+    {
+        return;
+    }
+
+    std::vector<int> region;
+    FillRegion(level, node.key, region);
+
+    for (int target : region)
+    {
+        StateKey key = node.key;
+
+        if (!ExplodeCell(level, region, target, key))
+        {
+            continue;
+        }
+
+        SetRegion(key, dynamite - 1, GetRegionCell(key));
+
+        std::vector<int> nextRegion;
+        bool finished = NormaliseState(level, key, nextRegion);
+        int next = table.Insert(key, identifier, target);
+
+        if (next == -1)
+        {
+            continue;
+        }
+
+        if (finished)
+        {
+            int none = -1;
+            outGoal.compare_exchange_strong(none, next);
+        }
+
+        outNext.push_back(next);
+    }
+}
+
+// Search for the fewest dynamite needed to reach the finish.
+
+static SolverResult SolveLevel(const SolverLevel& level, int threadCount, int stateLimit)
+{
+    TranspositionTable table;
+    SolverResult result = {false, false, 0, 0};
+
+    // Insert the starting state.
+
+    StateKey startKey(level.brokenWords + level.pickupWords + 1, 0);
+    SetRegion(startKey, maxDynamite, level.startCell);
+
+    std::vector<int> region;
+    bool finished = NormaliseState(level, startKey, region);
+
+    std::vector<int> frontier = {table.Insert(startKey, -1, -1)};
+    std::atomic<int> goal = finished ? frontier[0] : -1;
+
+    // Search breadth-first, one layer per dynamite thrown.
+
+    while (goal == -1 && !frontier.empty() && table.GetCount() < stateLimit)
+    {
+        std::vector<WorkQueue> queues(threadCount);
+        std::vector<std::vector<int>> nextFrontiers(threadCount);
+        std::atomic<int> remaining = (int) frontier.size();
+
+        for (int i = 0; i < (int) frontier.size(); i++)
+        {
+            queues[i % threadCount].Push(frontier[i]);
+        }
+
+        // Each worker drains its own queue, then steals from the others.
+
+        auto worker = [&](int index)
+        {
+            while (remaining > 0)
+            {
+                int identifier;
+                bool found = queues[index].Pop(identifier);
+
+                for (int i = 1; i < threadCount && !found; i++)
+                {
+                    found = queues[(index + i) % threadCount].Steal(identifier);
+                }
+
+                if (!found)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                if (table.GetCount() < stateLimit)
+                {
+                    ExpandState(level, table, identifier, nextFrontiers[index], goal);
+                }
+
+                remaining--;
+            }
+        };
+
+        std::vector<std::thread> threads;
+
+        for (int i = 1; i < threadCount; i++)
+        {
+            threads.emplace_back(worker, i);
+        }
+
+        worker(0);
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        // Gather the next layer.
+
+        frontier.clear();
+
+        for (const std::vector<int>& next : nextFrontiers)
+        {
+            frontier.insert(frontier.end(), next.begin(), next.end());
+        }
+
+        result.dynamiteUsed++;
+    }
+
+    result.statesSearched = table.GetCount();
+    result.exhausted = goal == -1 && !frontier.empty();
+
+    if (goal == -1)
+    {
+        return result;
+    }
+
+    // Walk back from the goal to list the throw targets.
+
+    result.solvable = true;
+
+    for (SolverNode node = table.Get(goal); node.parent != -1; node = table.Get(node.parent))
+    {
+        result.route.insert(result.route.begin(), node.target);
+    }
+
+    result.dynamiteUsed = (int) result.route.size();
+
+    return result;
+}
+
+// Program entry point;
+// Usage: LevelSolver [--threads N] [--limit N] [level]...
+
+int main(int argc, char** argv)
+{
+    int threadCount = Max((int) std::thread::hardware_concurrency(), 1);
+    int stateLimit = 4000000;
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view argument = argv[i];
+
+        if (argument == "--threads" && i + 1 < argc)
+        {
+            threadCount = Clamp(std::stoi(argv[++i]), 1, 256);
+        }
+        else if (argument == "--limit" && i + 1 < argc)
+        {
+            stateLimit = Max(std::stoi(argv[++i]), 1);
+        }
+        else
+        {
+            names.emplace_back(argument);
+        }
+    }
+
+    // Solve every level if none were named.
+
+    if (names.empty())
+    {
+        for (const auto& file : std::filesystem::directory_iterator("levels"))
+        {
+            if (file.path().extension() == ".level")
+            {
+                names.push_back(file.path().stem().string());
+            }
+        }
+
+        std::sort(names.begin(), names.end());
+    }
+
+    int failures = 0;
+
+    for (const std::string& name : names)
+    {
+        LevelFile file = {};
+
+        if (!LoadLevelFile("levels/" + name + ".level", file) || file.tiles.empty())
+        {
+            std::cout << name << ": unreadable level" << std::endl;
+            failures++;
+
+            continue;
+        }
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        SolverLevel level = CreateSolverLevel(file);
+        SolverResult result = SolveLevel(level, threadCount, stateLimit);
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double duration = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+        // Report the result and the par route.
+
+        std::cout << name << ": ";
+
+        if (result.solvable)
+        {
+            std::cout << "solvable with " << result.dynamiteUsed << " dynamite, route:";
+
+            for (int cell : result.route)
+            {
+                std::cout << " (" << cell % level.width << ", " << cell / level.width << ") ->";
+            }
+
+            std::cout << " finish (" << level.finishCell % level.width << ", " << level.finishCell / level.width << ")";
+        }
+        else
+        {
+            std::cout << (result.exhausted ? "unknown, search limit reached" : "unsolvable");
+            failures++;
+        }
+
+        std::cout << " [" << result.statesSearched << " states, " << duration << "ms]" << std::endl;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "core/audio/sound_mixer.h"
+#include "core/input/controller.h"
+#include "core/video/renderer.h"
+#include "core/video/window.h"
+#include "game/camera/camera.h"
+#include "game/level/level.h"
+#include "game/menu/menu.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Validation results of one level.
+
+struct LevelReport
+{
+    std::string name;
+    bool loaded;
+    double loadTime;
+    double retryTime;
+    double averageTickTime;
+    double maxTickTime;
+    int ticks;
+    int peakEntities;
+    int peakParticles;
+    int outOfBounds;
+    bool completed;
+
+    double captureTime;
+    double rewindBytesPerSecond;
+};
+
+// Apply scripted input for a tick;
+// Walks in a square and throws dynamite in rotating directions.
+
+static void ApplyScript(Controller& controller, int tick, int tickRate)
+{
+    constexpr Button directions[] = {KEY_W, KEY_D, KEY_S, KEY_A};
+
+    int step = tick / tickRate;
+    Button direction = directions[step % 4];
+
+    for (Button button : directions)
+    {
+        bool held = (button == direction);
+
+        if (held != controller.IsHeldDown(button))
+        {
+            controller.OnButtonAction(button, held ? PRESS : RELEASE);
+        }
+    }
+
+    // Throw once every two seconds, just after changing direction.
+
+    int phase = tick % (tickRate * 2);
+
+    if (phase == 1)
+    {
+        controller.OnMousePosition(vector2f(2.0f, 0.0f).Rotated((float) step * 135.0f));
+        controller.OnButtonAction(MOUSE_LEFT, PRESS);
+    }
+    else if (phase == 2)
+    {
+        controller.OnButtonAction(MOUSE_LEFT, RELEASE);
+    }
+}
+
+// Load a level and simulate it for a number of ticks;
+// With rewind memory, the level's state is also captured into a rewind buffer every tick;
+// Levels that cannot be loaded are not simulated.
+
+static LevelReport ValidateLevel(std::string_view name, int tickCount, int tickRate, bool scripted, int rewindMemory)
+{
+    LevelReport report = {std::string(name), false, 0.0, 0.0, 0.0, 0.0, 0, 0, 0, 0, false, 0.0, 0.0};
+    float tickDelta = 1.0f / (float) tickRate;
+
+    // Each level starts from a fresh input state.
+
+    Controller controller;
+
+    auto loadStart = Clock::now();
+    report.loaded = Level::Load(name);
+    report.loadTime = std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count();
+
+    if (!report.loaded)
+    {
+        return report;
+    }
+
+    report.peakEntities = pLevel->GetEntityCount();
+
+    RewindBuffer rewind((size_t) rewindMemory * 1024, 60);
+    std::vector<unsigned char> state;
+
+    // Simulate until the tick count runs out or the level is completed.
+
+    while (report.ticks < tickCount && !pMenu)
+    {
+        if (scripted)
+        {
+            ApplyScript(controller, report.ticks, tickRate);
+        }
+
+        auto tickStart = Clock::now();
+
+        pCamera->Update(tickDelta);
+        pLevel->Update(tickDelta);
+        controller.Update();
+
+        double tickTime = std::chrono::duration<double, std::milli>(Clock::now() - tickStart).count();
+
+        report.averageTickTime += tickTime;
+        report.maxTickTime = Max(report.maxTickTime, tickTime);
+        report.peakEntities = Max(report.peakEntities, pLevel->GetEntityCount());
+        report.peakParticles = Max(report.peakParticles, pLevel->GetParticleCount());
+        report.ticks++;
+
+        if (rewindMemory > 0)
+        {
+            auto captureStart = Clock::now();
+
+            pLevel->SaveState(state);
+            rewind.Push(state);
+
+            report.captureTime += std::chrono::duration<double, std::micro>(Clock::now() - captureStart).count();
+        }
+    }
+
+    report.averageTickTime /= (double) Max(report.ticks, 1);
+    report.captureTime /= (double) Max(report.ticks, 1);
+    report.rewindBytesPerSecond = (double) rewind.GetUsedBytes() * tickRate / Max(rewind.GetFrameCount(), 1);
+    report.outOfBounds = pLevel->GetOutOfBoundsCount();
+    report.completed = pMenu != nullptr;
+
+    // Measure retrying the level, which resets it from its cached template.
+
+    auto retryStart = Clock::now();
+    Level::Load(name);
+    report.retryTime = std::chrono::duration<double, std::milli>(Clock::now() - retryStart).count();
+
+    Menu::Close();
+    Level::Unload();
+
+    return report;
+}
+
+// Program entry point;
+// Usage: LevelValidator [--ticks N] [--tick-rate N] [--script] [--rewind KIB]
+
+int main(int argc, char** argv)
+{
+    int tickCount = 1200;
+    int tickRate = 120;
+    bool scripted = false;
+    int rewindMemory = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view argument = argv[i];
+
+        if (argument == "--ticks" && i + 1 < argc)
+        {
+            tickCount = Max(std::stoi(argv[++i]), 0);
+        }
+        else if (argument == "--tick-rate" && i + 1 < argc)
+        {
+            tickRate = Clamp(std::stoi(argv[++i]), 1, 1000);
+        }
+        else if (argument == "--script")
+        {
+            scripted = true;
+        }
+        else if (argument == "--rewind" && i + 1 < argc)
+        {
+            rewindMemory = Clamp(std::stoi(argv[++i]), 0, 65536);
+        }
+        else
+        {
+            std::cout << "Usage: LevelValidator [--ticks N] [--tick-rate N] [--script] [--rewind KIB]" << std::endl;
+
+            return 2;
+        }
+    }
+
+    // Initialise headless engine subsystems for the levels to use.
+
+    Window window(960, 720, "Man of Destruction");
+    Renderer renderer("", "");
+    SoundMixer soundMixer;
+    Camera camera;
+
+    // Find every level file.
+
+    std::vector<std::string> names;
+
+    for (const auto& file : std::filesystem::directory_iterator("levels"))
+    {
+        if (file.path().extension() == ".level")
+        {
+            names.push_back(file.path().stem().string());
+        }
+    }
+
+    std::sort(names.begin(), names.end());
+
+    // Validate each level and report the results.
+
+    int failures = 0;
+
+    for (const std::string& name : names)
+    {
+        LevelReport report = ValidateLevel(name, tickCount, tickRate, scripted, rewindMemory);
+
+        if (!report.loaded)
+        {
+            std::cout << report.name << ": unreadable level [FAILED]" << std::endl;
+            failures++;
+
+            continue;
+        }
+
+        bool failed = report.outOfBounds > 0;
+
+        std::cout << report.name << ": load " << report.loadTime << "ms, retry " << report.retryTime
+                  << "ms, tick " << report.averageTickTime
+                  << "ms (max " << report.maxTickTime << "ms) over " << report.ticks << " ticks, "
+                  << report.peakEntities << " peak entities, "
+                  << report.peakParticles << " peak particles, " << report.outOfBounds << " out-of-bounds accesses"
+                  << (report.completed ? ", completed" : "") << (failed ? " [FAILED]" : "") << std::endl;
+
+        if (rewindMemory > 0)
+        {
+            std::cout << report.name << ": rewind capture " << report.captureTime << "us per tick, "
+                      << report.rewindBytesPerSecond / 1024.0 << " KiB per second of history" << std::endl;
+        }
+
+        if (failed)
+        {
+            failures++;
+        }
+    }
+
+    std::cout << names.size() - failures << " of " << names.size() << " levels passed." << std::endl;
+
+    // Release the cached levels before exiting.
+
+    LevelTemplate::ClearCache();
+
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "core/audio/sound_mixer.h"
+#include "core/input/controller.h"
+#include "core/video/renderer.h"
+#include "core/video/window.h"
+#include "game/camera/camera.h"
+#include "game/level/level.h"
+#include "game/menu/menu.h"
+#include "game/replay/replay.h"
+#include <chrono>
+#include <iostream>
+
+// Re-simulate a replay and check its completion time;
+// Returns true if the replay completes the level in the recorded time.
+
+static bool VerifyReplay(std::string_view path, SoundMixer& soundMixer)
+{
+    Replay replay;
+
+    if (!replay.Load(path))
+    {
+        std::cout << path << ": unreadable replay" << std::endl;
+
+        return false;
+    }
+
+    std::string_view name = replay.GetLevelName();
+
+    // Validate that the replay matches this build and level.
+
+    if (replay.GetVersion() != simulationVersion || replay.GetTickRate() <= 0)
+    {
+        std::cout << path << ": recorded with simulation version " << replay.GetVersion()
+                  << ", expected " << simulationVersion << std::endl;
+
+        return false;
+    }
+
+    if (replay.GetLevelHash() != Replay::HashLevel(name))
+    {
+        std::cout << path << ": level \"" << name << "\" differs from the recorded one" << std::endl;
+
+        return false;
+    }
+
+    // Simulate the level with the recorded input as fast as possible;
+    // Each replay starts from a fresh input state.
+
+    Controller controller;
+    Level::SetChainDelay(replay.GetChainDelay());
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    double startMixTime = soundMixer.GetMixTime();
+
+    float tickDelta = 1.0f / (float) replay.GetTickRate();
+    int ticks = 0;
+
+    if (!Level::Load(name))
+    {
+        std::cout << path << ": unreadable level \"" << name << "\"" << std::endl;
+
+        return false;
+    }
+
+    while (!pMenu && replay.Playback(*pController))
+    {
+        pCamera->Update(tickDelta);
+        pLevel->Update(tickDelta);
+        soundMixer.Update(tickDelta);
+        pController->Update();
+
+        ticks++;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    double duration = std::chrono::duration<double>(endTime - startTime).count();
+    double mixTime = soundMixer.GetMixTime() - startMixTime;
+
+    // The level opens its completion menu once the finish is reached.
+
+    bool completed = pMenu != nullptr;
+    double time = pLevel->GetTime();
+
+    Menu::Close();
+    Level::Unload();
+
+    double simulatedTime = (double) ticks * (double) tickDelta;
+    double speed = simulatedTime / Max(duration, 1e-9);
+
+    if (!completed)
+    {
+        std::cout << path << ": did not complete \"" << name << "\" after " << ticks << " ticks" << std::endl;
+
+        return false;
+    }
+
+    if (ticks != replay.GetTickCount() || fabs(time - replay.GetTime()) > 1e-9)
+    {
+        std::cout << path << ": completed in " << Level::TimeToString(time) << ", but "
+                  << Level::TimeToString(replay.GetTime()) << " was reported" << std::endl;
+
+        return false;
+    }
+
+    std::cout << path << ": verified " << Level::TimeToString(time) << " on \"" << name << "\" ("
+              << ticks << " ticks, " << (int) speed << "x real time, mixing "
+              << mixTime * 1000.0 / Max(simulatedTime, 1e-9) << "ms per second)" << std::endl;
+
+    return true;
+}
+
+// Program entry point;
+// Usage: ReplayVerifier [--audio WAV] <replay>...
+
+int main(int argc, char** argv)
+{
+    std::string_view audioPath;
+    int first = 1;
+
+    if (argc > 2 && std::string_view(argv[1]) == "--audio")
+    {
+        audioPath = argv[2];
+        first = 3;
+    }
+
+    if (first >= argc)
+    {
+        std::cout << "Usage: ReplayVerifier [--audio WAV] <replay>..." << std::endl;
+
+        return 2;
+    }
+
+    // Initialise headless engine subsystems for the level to use;
+    // Sound is mixed in step with the simulation, then saved or discarded.
+
+    Window window(960, 720, "Man of Destruction");
+    Renderer renderer("", "");
+    SoundMixer soundMixer(audioPath);
+    Camera camera;
+
+    // Verify each replay in turn.
+
+    int failures = 0;
+
+    for (int i = first; i < argc; i++)
+    {
+        if (!VerifyReplay(argv[i], soundMixer))
+        {
+            failures++;
+        }
+    }
+
+    // Release the cached levels before exiting.
+
+    LevelTemplate::ClearCache();
+
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file